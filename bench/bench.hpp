@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+using std::string;
+
+
+namespace Bench {
+
+/* best of `repeat` runs of `body`, in seconds */
+template<typename Body> double measure(Body&& body, const unsigned repeat=5) {
+    using Clock = std::chrono::steady_clock;
+    double best = 1e300;
+    for (unsigned i = 0; i < repeat; ++i) {
+        const auto start = Clock::now();
+        body();
+        const std::chrono::duration<double> elapsed = Clock::now() - start;
+        if (elapsed.count() < best) best = elapsed.count();
+    }
+    return best;
+}
+
+inline void report(const string& name, const size_t bytes, const double time) {
+    std::cout << std::left << std::setw(40) << name << std::right
+        << std::setw(10) << bytes / 1024 << " KiB"
+        << std::setw(12) << std::fixed << std::setprecision(3)
+        << time * 1000 << " ms"
+        << std::setw(12) << std::setprecision(2)
+        << bytes / time / (1024 * 1024) << " MiB/s" << std::endl;
+}
+
+/* line oriented program text of roughly `size` bytes */
+inline string program(const size_t size) {
+    static const char* lines[] = {
+        "define add(a, b):\n",
+        "    result = a + b * (c - 42)\n",
+        "    return result\n",
+        "value_1 = add(10, 2) / divisor\n",
+        "while counter == 0:\n",
+        "    counter = call(nested(45 / 3), name, void())\n",
+    };
+    string text;
+    for (size_t i = 0; text.size() < size; ++i)
+        text += lines[i % (sizeof(lines) / sizeof(*lines))];
+    return text;
+}
+
+}
@@ -0,0 +1,29 @@
+#include "bench.hpp"
+#include "../src/incremental.hpp"
+
+
+int main() {
+    const Lexer lexer;
+
+    for (const size_t size: {64u << 10, 1u << 20, 8u << 20}) {
+        const string text = Bench::program(size);
+        Bench::report("IncrementalUnit, full build", text.size(),
+            Bench::measure([&] { IncrementalUnit(lexer, text); }, 3)
+        );
+
+        /* a keystroke typed and erased again in the middle of the unit */
+        IncrementalUnit unit(lexer, text);
+        const size_t offset = text.find(" = ", text.size() / 2) + 3;
+        const unsigned edits = 1000;
+        const double time = Bench::measure([&] {
+            for (unsigned i = 0; i < edits; ++i) {
+                unit.edit(offset, 0, "1");
+                unit.edit(offset, 1, "");
+            }
+        }, 3);
+        std::cout << "    " << std::setprecision(2)
+            << time / (2 * edits) * 1e6 << " us per edit, "
+            << unit.size() << " lines" << std::endl;
+    }
+    return 0;
+}
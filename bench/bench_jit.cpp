@@ -0,0 +1,154 @@
+#include <algorithm>
+
+#include "bench.hpp"
+#include "../src/jit.hpp"
+#include "../src/optimizer.hpp"
+#include "../src/unit.hpp"
+
+
+namespace {
+
+/* `count` functions of a loop and a branch each, and a main calling one */
+string functions(const size_t count) {
+    string text;
+    for (size_t i = 0; i < count; ++i) {
+        const string name = "f" + std::to_string(i);
+        text += "define " + name + "(a, b):\n"
+            "    total = 0\n"
+            "    while a:\n"
+            "        total = total + b * a\n"
+            "        a = a - 1\n"
+            "    if total == 0:\n"
+            "        return b\n"
+            "    return total / 2\n";
+    }
+    return text + "return f0(3, 4)\n";
+}
+
+/* source parsed and generated into main of a fresh module */
+struct Program {
+    Session session{"bench"};
+
+    Program(const string& source, const Lexer& lexer) {
+        CompilationUnit unit(source, lexer);
+        unit.parse();
+        session.function("main");
+        unit.codegen(session);
+    }
+};
+
+/* keeps a result the optimizer would drop otherwise */
+volatile int sink;
+
+__attribute__((noinline)) int add(const int a, const int b) { return a + b; }
+
+__attribute__((noinline)) int count(int n) {
+    int total = 0;
+    while (n) {
+        total = total + n;
+        n = n - 1;
+    }
+    return total;
+}
+
+/* calls of call(sum, i) folded into sum */
+template<typename Call>
+void perCall(const string& name, const size_t calls, Call&& call) {
+    const double time = Bench::measure([&] {
+        int sum = 0;
+        for (size_t i = 0; i < calls; ++i)
+            sum = call(sum, static_cast<int>(i));
+        sink = sum;
+    });
+    std::cout << std::left << std::setw(40) << name << std::right
+        << std::setw(12) << std::fixed << std::setprecision(2)
+        << time / calls * 1e9 << " ns per call" << std::endl;
+}
+
+const char* name(const OptLevel level) {
+    switch (level) {
+        case OptLevel::O0: return "O0";
+        case OptLevel::O1: return "O1";
+        case OptLevel::O2: return "O2";
+        case OptLevel::O3: return "O3";
+    }
+    return "?";
+}
+
+/* the functions of source at level, compiled and looked up */
+void compile(const string& source, const size_t count, const Lexer& lexer,
+    const OptLevel level) {
+    Program program(source, lexer);
+    JitRunner jit;
+    Optimizer(level).run(program.session.getModule(), &jit.getTarget());
+    jit.add(program.session);
+    for (size_t i = 0; i < count; ++i)
+        jit.lookup<int(int, int)>("f" + std::to_string(i));
+}
+
+}
+
+
+int main() {
+    const Lexer lexer;
+    const OptLevel levels[] = {
+        OptLevel::O0, OptLevel::O1, OptLevel::O2, OptLevel::O3
+    };
+
+    for (const size_t count: {1, 10, 100, 1000}) {
+        const string source = functions(count);
+        Bench::report("parse and codegen, " + std::to_string(count) +
+            " functions", source.size(),
+            Bench::measure([&] { Program(source, lexer); }));
+    }
+    const string source = functions(100);
+    for (const OptLevel level: levels)
+        Bench::report(string("compile at ") + name(level) +
+            ", 100 functions", source.size(),
+            Bench::measure([&] { compile(source, 100, lexer, level); }));
+
+    /* where O2 spends its time, the passes run inside each one excluded */
+    Optimizer optimizer(OptLevel::O2);
+    Program passes(source, lexer);
+    const JitRunner host;
+    optimizer.run(passes.session.getModule(), &host.getTarget());
+    vector<PassTime> times = optimizer.getTimes();
+    std::sort(times.begin(), times.end(),
+        [](const PassTime& a, const PassTime& b) {
+            return a.seconds > b.seconds;
+        });
+    std::cout << "O2 passes, 100 functions: " << times.size() << " passes, "
+        << std::setprecision(3) << optimizer.getSeconds() * 1000 << " ms"
+        << std::endl;
+    for (size_t i = 0; i < times.size() && i < 10; ++i)
+        std::cout << "    " << std::left << std::setw(36) << times[i].name
+            << std::right << std::setw(12) << times[i].seconds * 1000
+            << " ms" << std::setw(8) << times[i].runs << " runs" << std::endl;
+
+    const size_t calls = 10000000;
+    /* read each time, so no call is folded away */
+    static volatile int limit = 1000;
+    for (const OptLevel level: levels) {
+        JitRunner jit;
+        Program program("define add(a, b):\n    return a + b\n"
+            "define count(n):\n"
+            "    total = 0\n"
+            "    while n:\n"
+            "        total = total + n\n"
+            "        n = n - 1\n"
+            "    return total\n"
+            "return 0\n", lexer);
+        Optimizer(level).run(program.session.getModule(), &jit.getTarget());
+        jit.add(program.session);
+
+        const string suffix = string(", jit ") + name(level);
+        perCall("add" + suffix, calls, jit.lookup<int(int, int)>("add"));
+        auto* jitCount = jit.lookup<int(int)>("count");
+        perCall("count(1000)" + suffix, calls / 1000,
+            [&](int, int) { return jitCount(limit); });
+    }
+    perCall("add, c++ -O2", calls, add);
+    perCall("count(1000), c++ -O2", calls / 1000,
+        [](int, int) { return count(limit); });
+    return 0;
+}
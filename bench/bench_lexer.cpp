@@ -0,0 +1,136 @@
+#include <cstdlib>
+#include <new>
+#include <regex>
+#include <sstream>
+
+#include "bench.hpp"
+#include "../src/lexer.hpp"
+#include "../src/unit.hpp"
+#include "../src/stream.hpp"
+
+
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    if (void* memory = std::malloc(size)) return memory;
+    throw std::bad_alloc();
+}
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+
+
+namespace {
+
+/* the previous engine: every token regex rebuilt and tried at every position */
+class RegexLexer {
+    const vector<std::pair<string, Tag>> tokens = {
+        {"[ ]{4}", Tag::SEPARATOR}, {"[ ]", Tag::SEPARATOR},
+        {"\\d+", Tag::INTEGER},
+        {"\\n", Tag::EOL},
+        {"(define)|(while)|(if)|(else)|(return)|(declare)", Tag::KEYWORD},
+        {"\\w+", Tag::NAME}, {",", Tag::COMMA}, {":", Tag::COLON},
+        {"\\(", Tag::LEFT_BRACKET}, {"\\)", Tag::RIGHT_BRACKET},
+        {"(\\-)|(\\+)|(/)|(\\*)|(==)", Tag::OPERATOR}, {"=", Tag::ASSIGN},
+    };
+
+public:
+    size_t tokenize(const string& str) const {
+        size_t position = 0, count = 0;
+        while (position < str.size()) {
+            size_t length = 0;
+            for (const auto& token: tokens) {
+                std::smatch match;
+                std::regex pattern(token.first);
+                if (std::regex_search(str.begin() + position, str.end(),
+                        match, pattern) && match.position() == 0) {
+                    length = match.length();
+                    break;
+                }
+            }
+            if (length == 0) throw SyntaxError();
+            position += length;
+            count++;
+        }
+        return count;
+    }
+};
+
+/* loops nested `depth` deep, three statements on every level */
+string nested(const size_t depth, const size_t size) {
+    string text;
+    while (text.size() < size) {
+        for (size_t level = 0; level < depth; ++level) {
+            const string indent(level * Lexer::INDENT_WIDTH, ' ');
+            text += indent + "while counter == " + std::to_string(level) +
+                ":\n";
+            for (int i = 0; i < 3; ++i)
+                text += indent + "    value = value + counter\n";
+        }
+    }
+    return text;
+}
+
+}
+
+
+int main() {
+    const Lexer lexer;
+    const RegexLexer regexLexer;
+
+    {
+        const string text = Bench::program(64u << 20);
+        for (const unsigned threads: {1, 2, 4, 8}) {
+            llvm::ThreadPool pool(llvm::hardware_concurrency(threads));
+            Bench::report("Lexer::tokenize, threads " +
+                std::to_string(threads), text.size(),
+                Bench::measure([&] { lexer.tokenize(text, pool); }, 3)
+            );
+        }
+    }
+
+    for (const size_t depth: {2, 8, 32}) {
+        const string text = nested(depth, 4u << 20);
+        vector<Lexem> lexems;
+        Bench::report("Lexer::tokenize, " + std::to_string(depth) +
+            " levels deep", text.size(),
+            Bench::measure([&] { lexems = lexer.tokenize(text); })
+        );
+        /* a BLOCK per level and line before INDENT and DEDENT */
+        size_t indents = 0, levels = 0, start = 0;
+        for (const Lexem& lexem: lexems)
+            indents += lexem.getTag() == Tag::INDENT ||
+                lexem.getTag() == Tag::DEDENT;
+        for (size_t end; (end = text.find('\n', start)) != string::npos;
+                start = end + 1)
+            levels += (text.find_first_not_of(' ', start) - start) /
+                Lexer::INDENT_WIDTH;
+        std::cout << "    " << lexems.size() << " lexems, " << indents
+            << " of them INDENT or DEDENT, " << levels << " BLOCKs before"
+            << std::endl;
+    }
+
+    for (const size_t size: {64u << 10, 4u << 20, 16u << 20}) {
+        const string text = Bench::program(size);
+        Bench::report("Lexer::tokenize", text.size(),
+            Bench::measure([&] { lexer.tokenize(text); })
+        );
+        Bench::report("LexemStream::nextLine, chunks", text.size(),
+            Bench::measure([&] {
+                std::istringstream input(text);
+                LexemStream stream(input, lexer);
+                vector<Lexem> line;
+                while (stream.nextLine(line));
+            })
+        );
+        allocations = 0;
+        const CompilationUnit unit(text, lexer);
+        std::cout << "    " << allocations << " allocations for "
+            << unit.getLexems().size() << " lexems" << std::endl;
+        if (size <= (64u << 10))
+            Bench::report("regex per token (previous)", text.size(),
+                Bench::measure([&] { regexLexer.tokenize(text); }, 1)
+            );
+    }
+    return 0;
+}
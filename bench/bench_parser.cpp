@@ -0,0 +1,319 @@
+#include <cstdlib>
+#include <new>
+
+#include "bench.hpp"
+#include "../src/parser.hpp"
+#include "../src/unit.hpp"
+#include "../src/visitor.hpp"
+
+
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    if (void* memory = std::malloc(size)) return memory;
+    throw std::bad_alloc();
+}
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+
+
+namespace {
+
+/* top level statements only, one per line */
+string statements(const size_t count) {
+    static const char* lines[] = {
+        "value = 56\n",
+        "res = 2 + add(45, variable)\n",
+        "call(nested(45 / 3), name, void())\n",
+        "total = (a + b) * (c - 42) / divisor\n",
+    };
+    string text;
+    for (size_t i = 0; i < count; ++i)
+        text += lines[i % (sizeof(lines) / sizeof(*lines))];
+    return text;
+}
+
+/* a single expression of `terms` operands over every precedence level */
+string chain(const size_t terms) {
+    static const char* operators[] = {" + ", " * ", " - ", " / ", " == "};
+    string text = "t0";
+    for (size_t i = 1; i < terms; ++i)
+        text += string(operators[i % 5]) + "t" + std::to_string(i % 100);
+    return text;
+}
+
+/* one line in two broken, like expressions typed in by users */
+string mistakes(const size_t count) {
+    static const char* lines[] = {
+        "value = 56\n",
+        "res = 2 + add(45, variable\n",
+        "call(nested(45 / 3), name, void())\n",
+        "total = (a + b) * (c - 42) /\n",
+        "x = y\n",
+        "f(a,, b)\n",
+        "y = = 2 * z\n",
+        "print(res, call)\n",
+    };
+    string text;
+    for (size_t i = 0; i < count; ++i)
+        text += lines[i % (sizeof(lines) / sizeof(*lines))];
+    return text;
+}
+
+/* statements and errors, a broken line is skipped to its end */
+std::pair<size_t, size_t> recover(
+    const vector<Lexem>& lexems, const StatementParser& parser,
+    const bool throwing
+) {
+    size_t statements = 0, errors = 0;
+    for (CLIter cursor = lexems.begin(); cursor != lexems.end(); ) {
+        ParseResult result;
+        if (throwing) {
+            try {
+                result = parser.parse(cursor, lexems.end());
+            } catch (const ParseError&) {
+                result.error = ParseErrorCode::UNEXPECTED_LEXEM;
+            }
+        } else {
+            result = parser.parse(cursor, lexems.end());
+        }
+
+        if (!result.isError()) {
+            statements += !result.isEmpty();
+            delete result.ast;
+            cursor = result.cursor;
+            continue;
+        }
+        ++errors;
+        while (cursor != lexems.end() && cursor->getTag() != Tag::EOL)
+            ++cursor;
+        if (cursor != lexems.end()) ++cursor;
+    }
+    return {statements, errors};
+}
+
+/* calls nested `depth` deep, the innermost left open when unclosed */
+string nested(const size_t depth, const bool unclosed=false) {
+    string text = "x = ";
+    for (size_t i = 0; i < depth; ++i) text += "f(1, g(";
+    text += "2";
+    for (size_t i = 0; i < depth; ++i) text += unclosed ? ")" : "))";
+    return text;
+}
+
+/* heap trees are deleted one by one, arena trees go with their arena */
+size_t parse(const vector<Lexem>& lexems, Arena* arena=nullptr) {
+    const StatementParser parser(arena);
+    size_t count = 0;
+    for (CLIter cursor = lexems.begin(); cursor != lexems.end(); ++count) {
+        const ParseResult result = parser.parse(cursor, lexems.end());
+        if (arena == nullptr) delete result.ast;
+        cursor = result.cursor;
+    }
+    return count;
+}
+
+/* the statements of one parse, all in one flat tree */
+size_t parse(const vector<Lexem>& lexems, FlatAST& tree) {
+    const FlatStatementParser parser(tree);
+    size_t count = 0;
+    for (CLIter cursor = lexems.begin(); cursor != lexems.end(); ++count)
+        cursor = parser.parse(cursor, lexems.end()).cursor;
+    return count;
+}
+
+}
+
+
+int main() {
+    const Lexer lexer;
+
+    const string text = statements(100000);
+    const vector<Lexem> lexems = lexer.tokenize(text);
+    Bench::report("StatementParser", text.size(),
+        Bench::measure([&] { parse(lexems); }, 3)
+    );
+
+    allocations = 0;
+    const size_t count = parse(lexems);
+    std::cout << "    " << std::setprecision(2)
+        << double(allocations) / count << " allocations per statement"
+        << std::endl;
+
+    for (const bool predictive: {false, true}) {
+        StatementParser parser;
+        parser.setPredictive(predictive);
+        const double time = Bench::measure([&] {
+            for (CLIter cursor = lexems.begin(); cursor != lexems.end(); ) {
+                const ParseResult result = parser.parse(cursor, lexems.end());
+                delete result.ast;
+                cursor = result.cursor;
+            }
+        }, 5);
+        Bench::report(predictive ? "StatementParser, FIRST sets" :
+            "StatementParser, alternatives in turn", text.size(), time);
+
+        Grammar::Counters counters;
+        parser.setCounters(&counters);
+        for (CLIter cursor = lexems.begin(); cursor != lexems.end(); ) {
+            const ParseResult result = parser.parse(cursor, lexems.end());
+            delete result.ast;
+            cursor = result.cursor;
+        }
+        std::cout << "    " << std::setprecision(2)
+            << double(counters.attempts) / lexems.size()
+            << " alternatives attempted per lexem, "
+            << double(counters.failures) / lexems.size() << " failed"
+            << std::endl;
+    }
+
+    {
+        /* a unit per row, arenas grown by one row would favour the next */
+        const string source = statements(200000);
+        {
+            CompilationUnit unit(source, lexer);
+            Bench::report("CompilationUnit::parse", source.size(),
+                Bench::measure([&] { unit.parse(); }, 3)
+            );
+        }
+        for (const unsigned threads: {1, 2, 4, 8, 16}) {
+            CompilationUnit unit(source, lexer);
+            llvm::ThreadPool pool(llvm::hardware_concurrency(threads));
+            Bench::report("CompilationUnit::parse, threads " +
+                std::to_string(threads), source.size(),
+                Bench::measure([&] { unit.parse(pool); }, 3)
+            );
+        }
+    }
+
+    {
+        const string broken = mistakes(100000);
+        const vector<Lexem> lexems = lexer.tokenize(broken);
+        for (const bool throwing: {true, false}) {
+            StatementParser parser;
+            parser.setThrowing(throwing);
+            std::pair<size_t, size_t> counts;
+            /* a rejected line deletes what it parsed, none may be left */
+            const size_t live = BaseAST::getHeapNodes();
+            const double time = Bench::measure([&] {
+                counts = recover(lexems, parser, throwing);
+            }, 5);
+            Bench::report(throwing ? "StatementParser, errors thrown" :
+                "StatementParser, errors returned", broken.size(), time);
+            std::cout << "    " << counts.first << " statements, "
+                << counts.second << " errors, " << std::setprecision(1)
+                << time / (counts.first + counts.second) * 1e9
+                << " ns per line, " << BaseAST::getHeapNodes() - live
+                << " nodes leaked" << std::endl;
+        }
+    }
+
+    Bench::report("StatementParser, arena", text.size(),
+        Bench::measure([&] {
+            Arena arena;
+            parse(lexems, &arena);
+        }, 3)
+    );
+    {
+        allocations = 0;
+        Arena arena;
+        parse(lexems, &arena);
+        std::cout << "    " << std::setprecision(2)
+            << double(allocations) / count << " operator new per statement, "
+            << arena.getNodes() << " nodes, "
+            << double(arena.getBytes()) / arena.getNodes()
+            << " bytes per node, " << arena.getCapacity() / 1024
+            << " KiB reserved" << std::endl;
+    }
+
+    Bench::report("FlatStatementParser", text.size(),
+        Bench::measure([&] {
+            FlatAST tree;
+            parse(lexems, tree);
+        }, 3)
+    );
+    {
+        allocations = 0;
+        FlatAST tree;
+        parse(lexems, tree);
+        std::cout << "    " << std::setprecision(2)
+            << double(allocations) / count << " operator new per statement, "
+            << tree.size() << " nodes, "
+            << double(tree.getBytes()) / tree.size()
+            << " bytes per node" << std::endl;
+
+        /* a full pass over every tree, printing needs no LLVM context */
+        Arena arena;
+        const StatementParser parser(&arena);
+        vector<BaseAST*> roots;
+        for (CLIter cursor = lexems.begin(); cursor != lexems.end(); ) {
+            const ParseResult result = parser.parse(cursor, lexems.end());
+            if (!result.isEmpty()) roots.push_back(result.ast);
+            cursor = result.cursor;
+        }
+        size_t printed = 0;
+        const double nodes = Bench::measure([&] {
+            printed = 0;
+            for (const BaseAST* root: roots) printed += root->str().size();
+        }, 3);
+        Bench::report("print, arena nodes", printed, nodes);
+        const double flat = Bench::measure([&] {
+            string out;
+            printed = 0;
+            for (const NodeId root: tree.getRoots()) {
+                out.clear();
+                tree.print(root, out);
+                printed += out.size();
+            }
+        }, 3);
+        Bench::report("print, flat nodes", printed, flat);
+
+        size_t visited = 0;
+        const double walk = Bench::measure([&] {
+            visited = 0;
+            for (const BaseAST* root: roots)
+                visited += CountVisitor().visit(*root);
+        }, 5);
+        std::cout << "    " << std::setprecision(2) << walk * 1e9 / visited
+            << " ns per node visited, " << visited << " nodes" << std::endl;
+    }
+
+    for (const size_t terms: {1000, 10000, 100000}) {
+        const string expression = chain(terms);
+        const vector<Lexem> lexems = lexer.tokenize(expression);
+        const BinaryParser parser;
+        const double time = Bench::measure([&] {
+            delete parser.parse(lexems.begin(), lexems.end()).ast;
+        }, 3);
+        Bench::report("BinaryParser, " + std::to_string(terms) + " terms",
+            expression.size(), time);
+
+        allocations = 0;
+        delete parser.parse(lexems.begin(), lexems.end()).ast;
+        std::cout << "    " << std::setprecision(1)
+            << time / terms * 1e9 << " ns per term, "
+            << std::setprecision(2) << double(allocations) / (terms - 1)
+            << " allocations per operator" << std::endl;
+    }
+
+    for (const size_t depth: {1000, 10000, 100000, 1000000}) {
+        for (const bool unclosed: {false, true}) {
+            const string expression = nested(depth, unclosed);
+            const vector<Lexem> lexems = lexer.tokenize(expression);
+            const double time = Bench::measure([&] {
+                Arena arena;
+                StatementParser parser(&arena);
+                try {
+                    parser.parse(lexems.begin(), lexems.end());
+                } catch (const ParseError&) {}
+            }, 3);
+            Bench::report("nested calls, " + std::to_string(depth) +
+                (unclosed ? " unclosed" : ""), expression.size(), time);
+            std::cout << "    " << std::setprecision(1)
+                << time / depth * 1e9 << " ns per level" << std::endl;
+        }
+    }
+
+    return 0;
+}
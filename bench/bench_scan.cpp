@@ -0,0 +1,140 @@
+#include "bench.hpp"
+#include "../src/lexer.hpp"
+#include "../src/scan.hpp"
+#include "../src/tokens.hpp"
+
+
+namespace {
+
+const char* name(const Isa isa) {
+    switch (isa) {
+        case Isa::SCALAR: return "scalar";
+        case Isa::SSE2: return "sse2";
+        case Isa::AVX2: return "avx2";
+    }
+    return "?";
+}
+
+/* long identifiers separated by single operators */
+string identifiers(const size_t size) {
+    string text;
+    for (size_t i = 0; text.size() < size; ++i)
+        text += "some_rather_long_identifier_" + std::to_string(i) +
+            (i % 8 == 7 ? "\n" : " + ");
+    return text;
+}
+
+/* deeply indented short statements */
+string indented(const size_t size) {
+    string text;
+    for (size_t i = 0; text.size() < size; ++i)
+        text += string(4 * (i % 24), ' ') + "x = 1\n";
+    return text;
+}
+
+/* runs of exactly `length` bytes of `c` */
+string runsOf(const char c, const size_t length, const size_t size) {
+    string text;
+    while (text.size() < size)
+        text += string(length, c) + "+";
+    return text;
+}
+
+/* every run of `cls` in text, the way the lexer walks it */
+size_t runs(const CharClass cls, const string& text) {
+    const char* cursor = text.data();
+    const char* end = cursor + text.size();
+    size_t count = 0;
+    while (cursor < end) {
+        const size_t run = span(cls, cursor, end);
+        cursor += run > 0 ? run : 1;
+        count += run;
+    }
+    return count;
+}
+
+/* calls of 256 arguments a line, far apart EOLs */
+string wide(const size_t size) {
+    string text;
+    while (text.size() < size) {
+        text += "f(";
+        for (size_t i = 0; i < 256; ++i)
+            text += "g(a, b), ";
+        text += "x)\n";
+    }
+    return text;
+}
+
+/* keeps a result the optimizer would drop otherwise */
+volatile size_t sink;
+
+/* statements ended by EOL over the lexems, the way the parsers look */
+size_t lines(const vector<Lexem>& lexems) {
+    size_t count = 0;
+    for (const Lexem& lexem: lexems)
+        count += lexem.getTag() == Tag::EOL;
+    return count;
+}
+
+/* the same over the tag column */
+size_t lines(const TokenBuffer& tokens) {
+    size_t count = 0;
+    for (size_t i = tokens.lineEnd(0); i < tokens.size();
+        i = tokens.lineEnd(i + 1))
+        ++count;
+    return count;
+}
+
+}
+
+
+int main() {
+    const Lexer lexer;
+    const Isa best = detectIsa();
+    const size_t size = 16u << 20;
+    const string words = identifiers(size);
+    const string spaces = indented(size);
+    const string program = Bench::program(size);
+    const string calls = wide(size);
+    TokenBuffer tokens[2];
+    lexer.tokenize(program, tokens[0]);
+    lexer.tokenize(calls, tokens[1]);
+    std::cout << tokens[0].size() << " lexems, " << sizeof(Lexem) <<
+        " bytes each as Lexem, " << tokens[0].getBytes() / tokens[0].size() <<
+        " in columns with spare capacity" << std::endl;
+    for (const string* text: {&program, &calls}) {
+        const vector<Lexem> lexems = lexer.tokenize(*text);
+        Bench::report(string("EOL, vector<Lexem>, ") +
+            (text == &program ? "program" : "wide"), text->size(),
+            Bench::measure([&] { sink = lines(lexems); }));
+    }
+
+    for (const Isa isa: {Isa::SCALAR, Isa::SSE2, Isa::AVX2}) {
+        if (!useIsa(isa)) continue;
+        const string suffix = string(" [") + name(isa) + "]";
+
+        for (const size_t length: {8, 32, 128}) {
+            const string text = runsOf('w', length, size);
+            Bench::report("span WORD, runs of " + std::to_string(length) +
+                suffix, text.size(),
+                Bench::measure([&] { runs(CharClass::WORD, text); }));
+        }
+
+        Bench::report("span WORD, identifiers" + suffix, words.size(),
+            Bench::measure([&] { runs(CharClass::WORD, words); }));
+        Bench::report("span SPACE, indented" + suffix, spaces.size(),
+            Bench::measure([&] { runs(CharClass::SPACE, spaces); }));
+        Bench::report("tokenize, identifiers" + suffix, words.size(),
+            Bench::measure([&] { lexer.tokenize(words); }));
+        Bench::report("tokenize, indented" + suffix, spaces.size(),
+            Bench::measure([&] { lexer.tokenize(spaces); }));
+        for (size_t i = 0; i < 2; ++i) {
+            const string kind = i == 0 ? ", program" : ", wide";
+            const size_t bytes = i == 0 ? program.size() : calls.size();
+            Bench::report("EOL, tag column" + kind + suffix, bytes,
+                Bench::measure([&] { sink = lines(tokens[i]); }));
+        }
+    }
+    useIsa(best);
+    return 0;
+}
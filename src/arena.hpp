@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+#include <llvm/Support/Allocator.h>
+
+
+/*
+ * Bump allocator owning the AST of one compilation unit. Nodes and argument
+ * vectors are carved out of large slabs and released all at once with the
+ * arena, no destructor runs for them.
+ */
+class Arena {
+    llvm::BumpPtrAllocator allocator;
+    size_t nodes = 0;
+
+public:
+    Arena() = default;
+    Arena(const Arena&) = delete;
+    Arena& operator = (const Arena&) = delete;
+    ~Arena() = default;
+
+    void* allocate(const size_t size, const size_t align) {
+        return allocator.Allocate(size, align);
+    }
+    void* allocateNode(const size_t size, const size_t align) {
+        ++nodes;
+        return allocate(size, align);
+    }
+    /* drops everything placed so far, the first slab is kept for reuse */
+    void reset() {
+        allocator.Reset();
+        nodes = 0;
+    }
+
+    /* AST nodes placed so far */
+    size_t getNodes() const { return nodes; }
+    /* bytes handed out, nodes and vectors alike */
+    size_t getBytes() const { return allocator.getBytesAllocated(); }
+    /* bytes reserved in slabs */
+    size_t getCapacity() const { return allocator.getTotalMemory(); }
+};
+
+
+/* standard allocator over an arena, or over the heap without one */
+template<typename T> class ArenaAllocator {
+    template<typename U> friend class ArenaAllocator;
+
+    Arena* arena = nullptr;
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    ArenaAllocator(Arena* a=nullptr) : arena(a) {}
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(const size_t n) {
+        return static_cast<T*>(arena == nullptr ?
+            ::operator new(n * sizeof(T)) :
+            arena->allocate(n * sizeof(T), alignof(T)));
+    }
+    void deallocate(T* memory, size_t) {
+        if (arena == nullptr) ::operator delete(memory);
+    }
+
+    Arena* getArena() const { return arena; }
+
+    template<typename U> bool operator == (const ArenaAllocator<U>& o) const {
+        return arena == o.arena;
+    }
+    template<typename U> bool operator != (const ArenaAllocator<U>& o) const {
+        return arena != o.arena;
+    }
+};
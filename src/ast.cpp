@@ -1,131 +1,120 @@
-#include <llvm/IR/Constants.h>
-#include <llvm/IR/DerivedTypes.h>
-#include <llvm/IR/Instructions.h>
-#include <llvm/IR/ValueSymbolTable.h>
+#include <atomic>
 
 #include "ast.hpp"
+#include "visitor.hpp"
 
 
-OpCode toOpCode(const std::string &op) {
-    OpCode code = OpCode::UNKNOWN;
+/* the node header, a whole word so that nodes stay pointer aligned */
+enum Owner : size_t { HEAP, ARENA };
 
-    if (op == "-") code = OpCode::SUB;
-    if (op == "+") code = OpCode::ADD;
-    if (op == "*") code = OpCode::MUL;
-    if (op == "/") code = OpCode::DIV;
+static std::atomic<size_t> heapNodes{0};
 
-    return code;
+void* BaseAST::operator new(const size_t size) {
+    auto* header = static_cast<size_t*>(::operator new(sizeof(size_t) + size));
+    *header = HEAP;
+    heapNodes.fetch_add(1, std::memory_order_relaxed);
+    return header + 1;
 }
 
-string toString(const OpCode code) {
-    switch (code) {
-        case OpCode::DIV:
-            return "/";
-        case OpCode::MUL:
-            return "*";
-        case OpCode::ADD:
-            return "+";
-        case OpCode::SUB:
-            return "-";
-        default:
-            return "@";
-    }
+void* BaseAST::operator new(const size_t size, Arena& arena) {
+    auto* header = static_cast<size_t*>(
+        arena.allocateNode(sizeof(size_t) + size, alignof(size_t)));
+    *header = ARENA;
+    return header + 1;
 }
 
+void BaseAST::operator delete(void* node) {
+    if (node == nullptr) return;
+    size_t* header = static_cast<size_t*>(node) - 1;
+    if (*header != HEAP) return;
+    heapNodes.fetch_sub(1, std::memory_order_relaxed);
+    ::operator delete(header);
+}
 
+size_t BaseAST::getHeapNodes() {
+    return heapNodes.load(std::memory_order_relaxed);
+}
 
 
-string IntegerType::str() const { return "[IntegerType]"; }
-
+void BaseAST::release(BaseAST* child) {
+    /* children met while deleting, the outermost release deletes them all */
+    thread_local vector<BaseAST*> pending;
+    thread_local bool releasing = false;
 
+    if (child == nullptr) return;
+    pending.push_back(child);
+    if (releasing) return;
 
+    releasing = true;
+    while (!pending.empty()) {
+        BaseAST* node = pending.back();
+        pending.pop_back();
+        delete node;
+    }
+    releasing = false;
+}
 
-IntegerAST::IntegerAST(const int i) : BaseAST(), value(i) {}
 
-llvm::Value* IntegerAST::codegen() {
-    return llvm::ConstantInt::get(
-        llvm::IntegerType::get(context, 32), value, true
-    );
+llvm::Value* BaseAST::codegen(Session& session) {
+    return CodegenVisitor(session).visit(*this);
 }
 
-string IntegerAST::str() const {
-    return "[IntegerAST: " + std::to_string(value) + "]";
+string BaseAST::str() const {
+    string out;
+    PrintVisitor(out).visit(*this);
+    return out;
 }
 
 
-
-NameAST::NameAST(const std::string &n, llvm::BasicBlock* b, Type* t) :
-    BaseAST(), name(n), block(b), type(t) {}
-
-llvm::Value* NameAST::codegen() {
-    llvm::Value* value = block->getValueSymbolTable()->lookup(name);
-    return value != nullptr ?
-        new llvm::LoadInst(value, name + ".load", block):
-        nullptr;
-}
-
-string NameAST::str() const {
-    return "[Name: " + name + " of " + type->str() + "]";
+string toString(const OpCode code) {
+    return code == OpCode::UNKNOWN ? "@" :
+        OPERATORS[static_cast<size_t>(code)].spelling;
 }
 
 
-llvm::Value* BinaryInstrAST::codegen() {
-    llvm::Value* instruction = nullptr;
-    llvm::Value* left = lhs->codegen();
-    llvm::Value* right = rhs->codegen();
-    return instruction;
-}
 
-string BinaryInstrAST::str() const {
-    return "[BinaryInstrAST: " + toString(opCode) + " "
-        + lhs->str() + " " + rhs->str() + "]";
-}
 
+string IntegerType::str() const { return "[IntegerType]"; }
 
-llvm::Value* CallInstrAST::codegen() {
-    llvm::Function* callFunction = module.getFunction(name);
+static IntegerType integerType;
 
-    if (callFunction == nullptr) return nullptr;
 
-    vector<llvm::Value*> argvs;
-    for (BaseAST* arg: arguments)
-        argvs.push_back(arg->codegen());
 
-    return llvm::CallInst::Create(callFunction, argvs, name + ".call", block);
-}
 
-string CallInstrAST::str() const {
-    string res = "[CallInstrAST: '" + name + "' (";
+IntegerAST::IntegerAST(const int i) : BaseAST(NodeKind::INTEGER), value(i) {}
 
-    const size_t length = arguments.size();
-    if (length == 0) return res += ")]";
 
-    for (size_t i = 0; i < length - 1; ++i)
-        res += arguments[i]->str() + ", ";
-    return res += arguments[length - 1]->str() + ")]";
-}
 
+NameAST::NameAST(Symbol n, Type* t) : BaseAST(NodeKind::NAME), name(n)
+    , type(t != nullptr ? t : &integerType) {}
 
 
-llvm::Value* AssignInstrAST::codegen() {
-    return new llvm::StoreInst(value->codegen(), new llvm::AllocaInst(
-            llvm::IntegerType::get(context, 32), 4, name, block
-        ), block
-    );
-}
 
-string AssignInstrAST::str() const {
-    return "[AssignInstrAST: " + name + " = " + value->str() + "]";
+PrototypeAST::PrototypeAST(const string &n, const vector<string> &args) :
+    BaseAST(NodeKind::PROTOTYPE), name(intern(n)) {
+    for (const string& argument: args)
+        arguments.push_back(intern(argument));
 }
+PrototypeAST::~PrototypeAST() {}
 
 
 
-PrototypeAST::PrototypeAST(
-    const string &n, const vector<string> &args, llvm::Module* m
-) : BaseAST(), name(n), arguments(args), module(m) {}
-PrototypeAST::~PrototypeAST() {}
-
+IfAST::~IfAST() {
+    release(condition);
+    for (BaseAST* statement: body)
+        release(statement);
+    for (BaseAST* statement: otherwise)
+        release(statement);
+}
 
-llvm::Value* PrototypeAST::codegen() {
+WhileAST::~WhileAST() {
+    release(condition);
+    for (BaseAST* statement: body)
+        release(statement);
+}
 
+FunctionAST::~FunctionAST() {
+    release(prototype);
+    for (BaseAST* statement: body)
+        release(statement);
 }
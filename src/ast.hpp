@@ -7,35 +7,13 @@ using std::vector;
 #include <map>
 using std::map;
 
-#include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Value.h>
-#include <llvm/IR/IRBuilder.h>
-#include <llvm/IR/Module.h>
-#include <llvm/IR/BasicBlock.h>
-using Block = llvm::BasicBlock;
 
+#include "arena.hpp"
+#include "lexer.hpp"
+#include "session.hpp"
 
-static llvm::LLVMContext context;
-static llvm::Module module("unnamed", context);
 
-
-enum class OpCode : unsigned short int {
-    ADD = 0,
-    SUB = 1,
-    MUL = 2,
-    DIV = 3,
-    UNKNOWN = 255
-};
-
-static const map <OpCode, unsigned short int> OP_WEIGHT = {
-    {OpCode::UNKNOWN, 0},
-    {OpCode::ADD, 1},
-    {OpCode::SUB, 1},
-    {OpCode::MUL, 2},
-    {OpCode::DIV, 2},
-};
-
-OpCode toOpCode(const string& op);
 string toString(const OpCode code);
 
 
@@ -49,23 +27,47 @@ public:
 
 
 class IntegerType final : public Type {
-    llvm::IntegerType* type;
-
 public:
-    IntegerType() : Type(), type(llvm::IntegerType::get(context, 32)) {}
+    IntegerType() = default;
     virtual ~IntegerType() override final {}
 
     string str() const override final;
 };
 
 
+/*
+ * Nodes carry their kind, passes over a tree are visitors of visitor.hpp
+ * that switch on it instead of virtual members of the nodes. No node holds
+ * an LLVM object, where code goes is up to the session generating it.
+ */
 class BaseAST {
+    const NodeKind kind;
+
 public:
-    BaseAST() = default;
+    explicit BaseAST(const NodeKind k) : kind(k) {}
+
+    /*
+     * A word in front of every node tells whether it lives in an arena, so
+     * delete releases heap nodes only and any tree may be deleted as before.
+     */
+    static void* operator new(size_t);
+    static void* operator new(size_t, Arena&);
+    static void operator delete(void*);
+    static void operator delete(void*, Arena&) {}
+    /* heap nodes not deleted yet, over all threads */
+    static size_t getHeapNodes();
+
+    NodeKind getKind() const { return kind; }
+
+    /* CodegenVisitor and PrintVisitor over this tree */
+    llvm::Value* codegen(Session&);
+    string str() const;
 
-    virtual llvm::Value* codegen() = 0;
-    virtual string str() const = 0;
     virtual ~BaseAST() = default;
+
+protected:
+    /* deletes a child, deep trees go iteratively instead of recursively */
+    static void release(BaseAST* child);
 };
 
 
@@ -76,116 +78,173 @@ public:
     IntegerAST(const int i);
     ~IntegerAST() override {}
 
-    llvm::Value* codegen() override;
-    string str() const override;
+    int getValue() const { return value; }
 };
 
 
 class NameAST final : public BaseAST {
-    string name;
-    Block* block;
+    Symbol name;
     Type* type;
 
 public:
-    NameAST(const string& n, Type* t) : BaseAST(),
-        name(n), type(t),
-        block(llvm::BasicBlock::Create(context, "default")) {}
-    NameAST(const string& n, Block* b, Type* t);
+    explicit NameAST(const string& n, Type* t=nullptr) :
+        NameAST(intern(n), t) {}
+    explicit NameAST(Symbol n, Type* t=nullptr);
     ~NameAST() override {}
 
-    llvm::Value* codegen() override;
-    string str() const override;
+    Symbol getName() const { return name; }
+    const Type* getType() const { return type; }
 };
 
 
 class BinaryInstrAST final : public BaseAST {
     BaseAST* lhs = nullptr;
     BaseAST* rhs = nullptr;
-    Block* block = nullptr;
     OpCode opCode = OpCode::UNKNOWN;
-    bool hasParen = false;
 
 public:
-    BinaryInstrAST(const string& op, BaseAST* l, BaseAST* r) :
-        BaseAST(), opCode(toOpCode(op)), lhs(l), rhs(r)
-        , block(llvm::BasicBlock::Create(context, "Default")),
-        hasParen(false) {}
-    BinaryInstrAST(
-        const string& op, BaseAST* l, BaseAST* r, Block* b, bool paren=false) :
-     BaseAST(), opCode(toOpCode(op)), lhs(l), rhs(r), block(b), hasParen(paren)
-     {}
+    BinaryInstrAST(llvm::StringRef op, BaseAST* l, BaseAST* r) :
+        BinaryInstrAST(toOpCode(op), l, r) {}
+    BinaryInstrAST(OpCode op, BaseAST* l, BaseAST* r) :
+        BaseAST(NodeKind::BINARY), lhs(l), rhs(r), opCode(op) {}
 
     ~BinaryInstrAST() override {
-        delete lhs;
-        delete rhs;
+        release(lhs);
+        release(rhs);
     }
 
     string getOperator() const { return toString(opCode); }
+    OpCode getOpCode() const { return opCode; }
     BaseAST* getLeft() const { return lhs; }
     BaseAST* getRight() const { return rhs; }
-
-    unsigned int weight() const {
-        return OP_WEIGHT.at(opCode) + (hasParen ? 10 : 0);
-    }
-
-    llvm::Value* codegen() override;
-    string str() const override;
 };
 
 
 class CallInstrAST final : public BaseAST {
-    using Args = vector<BaseAST*>;
+public:
+    /* lives in the same arena as the call */
+    using Arguments = vector<BaseAST*, ArenaAllocator<BaseAST*>>;
 
-    string name;
-    Args arguments;
-    Block* block = nullptr;
+private:
+    Symbol name;
+    Arguments arguments;
 
 public:
-    CallInstrAST(const string& fName, const Args& args) : BaseAST()
-        , name(fName), arguments(args)
-        , block(Block::Create(context, "Default")) {}
-    CallInstrAST(const string& fName, const Args& args, Block* b) :
-        BaseAST(), name(fName), arguments(args), block(b) {}
+    CallInstrAST(const string& fName, const vector<BaseAST*>& args) :
+        BaseAST(NodeKind::CALL)
+        , name(intern(fName)), arguments(args.begin(), args.end()) {}
+    CallInstrAST(Symbol fName, Arguments args) :
+        BaseAST(NodeKind::CALL), name(fName), arguments(std::move(args)) {}
 
     ~CallInstrAST() override {
         for (BaseAST* arg: arguments)
-            delete arg;
+            release(arg);
     }
 
-    llvm::Value* codegen() override;
-    string str() const override;
+    Symbol getName() const { return name; }
+    const Arguments& getArguments() const { return arguments; }
 };
 
 
 class AssignInstrAST final : public BaseAST {
-    string name;
+    Symbol name;
     BaseAST* value = nullptr;
-    Block* block = nullptr;
 
 public:
     AssignInstrAST(const string& n, BaseAST* v) :
-        BaseAST(), name(n), value(v),
-        block(llvm::BasicBlock::Create(context, "Default")) {}
-    AssignInstrAST(const string& n, BaseAST* v, Block* b) :
-        BaseAST(), name(n), value(v), block(b) {}
+        AssignInstrAST(intern(n), v) {}
+    AssignInstrAST(Symbol n, BaseAST* v) :
+        BaseAST(NodeKind::ASSIGN), name(n), value(v) {}
 
-    ~AssignInstrAST() override { delete value; }
+    ~AssignInstrAST() override { release(value); }
 
-    llvm::Value* codegen() override;
-    string str() const override;
+    Symbol getName() const { return name; }
+    BaseAST* getValue() const { return value; }
 };
 
 
 /* define function(Type: a, Type: b) -> Type:\n */
 class PrototypeAST final : public BaseAST {
-    string name;
-    vector<string> arguments;
-    llvm::Module* module;
+public:
+    /* lives in the same arena as the prototype */
+    using Arguments = vector<Symbol, ArenaAllocator<Symbol>>;
+
+private:
+    Symbol name;
+    Arguments arguments;
 
 public:
-    PrototypeAST(const string&, const vector<string>&, llvm::Module*);
+    PrototypeAST(const string&, const vector<string>&);
+    PrototypeAST(Symbol n, Arguments args) :
+        BaseAST(NodeKind::PROTOTYPE), name(n), arguments(std::move(args)) {}
     virtual ~PrototypeAST() override final;
 
-    llvm::Value* codegen() override;
-    string str() const override;
+    Symbol getName() const { return name; }
+    const Arguments& getArguments() const { return arguments; }
+};
+
+
+/* the statements of an indented body, in the same arena as its node */
+using Statements = vector<BaseAST*, ArenaAllocator<BaseAST*>>;
+
+
+class ReturnAST final : public BaseAST {
+    BaseAST* value = nullptr;
+
+public:
+    explicit ReturnAST(BaseAST* v) : BaseAST(NodeKind::RETURN), value(v) {}
+
+    ~ReturnAST() override { release(value); }
+
+    BaseAST* getValue() const { return value; }
+};
+
+
+/* if condition:\n body, else:\n otherwise and its body may be empty */
+class IfAST final : public BaseAST {
+    BaseAST* condition = nullptr;
+    Statements body;
+    Statements otherwise;
+
+public:
+    IfAST(BaseAST* c, Statements then, Statements other) :
+        BaseAST(NodeKind::IF), condition(c), body(std::move(then))
+        , otherwise(std::move(other)) {}
+
+    ~IfAST() override;
+
+    BaseAST* getCondition() const { return condition; }
+    const Statements& getBody() const { return body; }
+    const Statements& getElse() const { return otherwise; }
+};
+
+
+class WhileAST final : public BaseAST {
+    BaseAST* condition = nullptr;
+    Statements body;
+
+public:
+    WhileAST(BaseAST* c, Statements b) :
+        BaseAST(NodeKind::WHILE), condition(c), body(std::move(b)) {}
+
+    ~WhileAST() override;
+
+    BaseAST* getCondition() const { return condition; }
+    const Statements& getBody() const { return body; }
+};
+
+
+/* define name(a, b):\n body */
+class FunctionAST final : public BaseAST {
+    PrototypeAST* prototype = nullptr;
+    Statements body;
+
+public:
+    FunctionAST(PrototypeAST* p, Statements b) :
+        BaseAST(NodeKind::FUNCTION), prototype(p), body(std::move(b)) {}
+
+    ~FunctionAST() override;
+
+    const PrototypeAST* getPrototype() const { return prototype; }
+    const Statements& getBody() const { return body; }
 };
@@ -0,0 +1,416 @@
+#include <cassert>
+#include <cctype>
+#include <bitset>
+using std::bitset;
+#include <map>
+using std::map;
+#include <algorithm>
+using std::min;
+using std::sort;
+using std::unique;
+
+#include "automaton.hpp"
+
+
+namespace {
+
+using CharSet = bitset<256>;
+const unsigned int UNBOUNDED = ~0u;
+const unsigned int NONE = ~0u;
+
+
+struct Node {
+    enum Kind { SET, SEQUENCE, ALTERNATION, REPEAT };
+
+    Kind kind = SEQUENCE;
+    CharSet set;
+    vector<Node> children;
+    unsigned int min = 1;
+    unsigned int max = 1;
+};
+
+
+class PatternParser {
+    /*
+     * ALTERNATION = SEQUENCE | SEQUENCE '|' ALTERNATION
+     * SEQUENCE = REPEAT*
+     * REPEAT = ATOM | ATOM QUANTIFIER
+     * ATOM = '(' ALTERNATION ')' | '[' CLASS ']' | '\' CHAR | CHAR
+     */
+    const string& pattern;
+    size_t position = 0;
+
+public:
+    explicit PatternParser(const string& p) : pattern(p) {}
+
+    Node parse() {
+        Node root = alternation();
+        assert(position == pattern.size());
+        return root;
+    }
+
+private:
+    bool finish() const { return position == pattern.size(); }
+    char peek() const { return pattern[position]; }
+    char take() { return pattern[position++]; }
+
+    Node alternation();
+    Node sequence();
+    Node repeat();
+    Node atom();
+    CharSet charClass();
+    CharSet escape(const char) const;
+    unsigned int number();
+};
+
+Node PatternParser::alternation() {
+    Node first = sequence();
+    if (finish() || peek() != '|') return first;
+
+    Node node;
+    node.kind = Node::ALTERNATION;
+    node.children.push_back(first);
+    while (!finish() && peek() == '|') {
+        take();
+        node.children.push_back(sequence());
+    }
+    return node;
+}
+
+Node PatternParser::sequence() {
+    Node node;
+    node.kind = Node::SEQUENCE;
+    while (!finish() && peek() != '|' && peek() != ')')
+        node.children.push_back(repeat());
+    return node;
+}
+
+Node PatternParser::repeat() {
+    Node node = atom();
+    while (!finish()) {
+        unsigned int low = 0, high = 0;
+        switch (peek()) {
+            case '+': take(); low = 1; high = UNBOUNDED; break;
+            case '*': take(); low = 0; high = UNBOUNDED; break;
+            case '?': take(); low = 0; high = 1; break;
+            case '{':
+                take();
+                low = high = number();
+                if (peek() == ',') {
+                    take();
+                    high = peek() == '}' ? UNBOUNDED : number();
+                }
+                assert(peek() == '}');
+                take();
+                break;
+            default:
+                return node;
+        }
+        Node repeated;
+        repeated.kind = Node::REPEAT;
+        repeated.min = low;
+        repeated.max = high;
+        repeated.children.push_back(node);
+        node = repeated;
+    }
+    return node;
+}
+
+Node PatternParser::atom() {
+    assert(!finish());
+
+    Node node;
+    node.kind = Node::SET;
+    const char c = take();
+    switch (c) {
+        case '(':
+            node = alternation();
+            assert(!finish() && peek() == ')');
+            take();
+            return node;
+        case '[':
+            node.set = charClass();
+            return node;
+        case '\\':
+            assert(!finish());
+            node.set = escape(take());
+            return node;
+        case '.':
+            node.set.set();
+            node.set.reset('\n');
+            return node;
+        default:
+            node.set.set(static_cast<unsigned char>(c));
+            return node;
+    }
+}
+
+CharSet PatternParser::charClass() {
+    CharSet set;
+    const bool negate = !finish() && peek() == '^';
+    if (negate) take();
+
+    while (!finish() && peek() != ']') {
+        const char c = take();
+        if (c == '\\') {
+            set |= escape(take());
+            continue;
+        }
+        unsigned char last = static_cast<unsigned char>(c);
+        if (position + 1 < pattern.size() && peek() == '-' &&
+            pattern[position + 1] != ']') {
+                take();
+                last = static_cast<unsigned char>(take());
+        }
+        for (unsigned int i = static_cast<unsigned char>(c); i <= last; ++i)
+            set.set(i);
+    }
+    assert(!finish());
+    take();
+    return negate ? ~set : set;
+}
+
+CharSet PatternParser::escape(const char c) const {
+    CharSet set;
+    switch (c) {
+        case 'd':
+            for (char i = '0'; i <= '9'; ++i) set.set(i);
+            break;
+        case 'w':
+            for (char i = '0'; i <= '9'; ++i) set.set(i);
+            for (char i = 'a'; i <= 'z'; ++i) set.set(i);
+            for (char i = 'A'; i <= 'Z'; ++i) set.set(i);
+            set.set('_');
+            break;
+        case 's':
+            for (const char i: {' ', '\t', '\n', '\r', '\v', '\f'}) set.set(i);
+            break;
+        case 'n': set.set('\n'); break;
+        case 't': set.set('\t'); break;
+        default: set.set(static_cast<unsigned char>(c)); break;
+    }
+    return set;
+}
+
+unsigned int PatternParser::number() {
+    unsigned int value = 0;
+    assert(!finish() && std::isdigit(peek()));
+    while (!finish() && std::isdigit(peek()))
+        value = value * 10 + (take() - '0');
+    return value;
+}
+
+
+/* Thompson construction: every state has at most one byte transition */
+struct NfaState {
+    CharSet set;
+    unsigned int next = NONE;
+    vector<unsigned int> epsilon;
+    unsigned int rule = Automaton::NO_RULE;
+};
+
+struct Fragment {
+    unsigned int start;
+    unsigned int end;
+};
+
+class Nfa {
+public:
+    vector<NfaState> states;
+
+    unsigned int add() {
+        states.emplace_back();
+        return states.size() - 1;
+    }
+
+    void link(const unsigned int from, const unsigned int to) {
+        states[from].epsilon.push_back(to);
+    }
+
+    Fragment build(const Node&);
+    vector<unsigned int> closure(vector<unsigned int>) const;
+};
+
+Fragment Nfa::build(const Node& node) {
+    switch (node.kind) {
+        case Node::SET: {
+            const unsigned int start = add(), end = add();
+            states[start].set = node.set;
+            states[start].next = end;
+            return {start, end};
+        }
+        case Node::SEQUENCE: {
+            const unsigned int start = add();
+            Fragment result = {start, start};
+            for (const Node& child: node.children) {
+                const Fragment next = build(child);
+                link(result.end, next.start);
+                result.end = next.end;
+            }
+            return result;
+        }
+        case Node::ALTERNATION: {
+            const unsigned int start = add(), end = add();
+            for (const Node& child: node.children) {
+                const Fragment alternative = build(child);
+                link(start, alternative.start);
+                link(alternative.end, end);
+            }
+            return {start, end};
+        }
+        case Node::REPEAT: {
+            const unsigned int start = add();
+            unsigned int current = start;
+            for (unsigned int i = 0; i < node.min; ++i) {
+                const Fragment copy = build(node.children[0]);
+                link(current, copy.start);
+                current = copy.end;
+            }
+            if (node.max == UNBOUNDED) {
+                const unsigned int loop = add();
+                const Fragment copy = build(node.children[0]);
+                link(current, loop);
+                link(loop, copy.start);
+                link(copy.end, loop);
+                return {start, loop};
+            }
+            const unsigned int end = add();
+            for (unsigned int i = node.min; i < node.max; ++i) {
+                const Fragment copy = build(node.children[0]);
+                link(current, end);
+                link(current, copy.start);
+                current = copy.end;
+            }
+            link(current, end);
+            return {start, end};
+        }
+    }
+    assert(false);
+    return {NONE, NONE};
+}
+
+vector<unsigned int> Nfa::closure(vector<unsigned int> set) const {
+    vector<unsigned int> stack = set;
+    vector<bool> seen(states.size(), false);
+    for (const unsigned int state: set) seen[state] = true;
+
+    while (!stack.empty()) {
+        const unsigned int state = stack.back();
+        stack.pop_back();
+        for (const unsigned int next: states[state].epsilon) {
+            if (seen[next]) continue;
+            seen[next] = true;
+            set.push_back(next);
+            stack.push_back(next);
+        }
+    }
+    sort(set.begin(), set.end());
+    set.erase(unique(set.begin(), set.end()), set.end());
+    return set;
+}
+
+}
+
+
+const unsigned int Automaton::NO_RULE;
+
+Automaton::Automaton(const vector<string>& patterns) {
+    Nfa nfa;
+    const unsigned int start = nfa.add();
+    for (unsigned int rule = 0; rule < patterns.size(); ++rule) {
+        const Fragment fragment =
+            nfa.build(PatternParser(patterns[rule]).parse());
+        nfa.states[fragment.end].rule = rule;
+        nfa.link(start, fragment.start);
+    }
+
+    /* subset construction, the empty set becomes the dead state 0 */
+    using StateSet = vector<unsigned int>;
+    vector<StateSet> sets = {StateSet(), nfa.closure({start})};
+    map<StateSet, unsigned int> ids = {{sets[0], 0}, {sets[1], 1}};
+
+    for (unsigned int current = 0; current < sets.size(); ++current) {
+        array<unsigned int, 256> row;
+        unsigned int accept = NO_RULE;
+        for (const unsigned int state: sets[current])
+            accept = min(accept, nfa.states[state].rule);
+
+        for (unsigned int c = 0; c < 256; ++c) {
+            StateSet moved;
+            for (const unsigned int state: sets[current]) {
+                const NfaState& nfaState = nfa.states[state];
+                if (nfaState.next != NONE && nfaState.set.test(c))
+                    moved.push_back(nfaState.next);
+            }
+            moved = nfa.closure(moved);
+
+            auto found = ids.find(moved);
+            if (found == ids.end()) {
+                found = ids.emplace(moved, sets.size()).first;
+                sets.push_back(moved);
+            }
+            row[c] = found->second;
+        }
+        transitions.push_back(row);
+        accepts.push_back(accept);
+    }
+
+    for (const auto& row: transitions) {
+        const unsigned int state = runs.size();
+        CharClass run = CharClass::NONE;
+        for (const CharClass cls: {CharClass::WORD, CharClass::DIGIT}) {
+            bool loops = state != 0;
+            for (unsigned int c = 0; c < 256 && loops; ++c)
+                loops = !inClass(cls, c) || row[c] == state;
+            if (loops) {
+                run = cls;
+                break;
+            }
+        }
+        runs.push_back(run);
+    }
+
+    reaches = accepts;
+    for (bool changed = true; changed; ) {
+        changed = false;
+        for (unsigned int state = 0; state < transitions.size(); ++state) {
+            for (const unsigned int next: transitions[state]) {
+                if (reaches[next] < reaches[state]) {
+                    reaches[state] = reaches[next];
+                    changed = true;
+                }
+            }
+        }
+    }
+}
+
+Automaton::Match Automaton::match(const char* begin, const char* end) const {
+    Match result;
+    unsigned int state = 1;
+    const char* cursor = begin;
+
+    while (true) {
+        const unsigned int rule = accepts[state];
+        if (rule != NO_RULE && rule <= result.rule) {
+            result.rule = rule;
+            result.length = cursor - begin;
+        }
+        /* nothing reachable can beat or extend the current match */
+        if (reaches[state] > result.rule) break;
+        if (cursor == end) {
+            result.partial = reaches[state] != NO_RULE;
+            break;
+        }
+
+        if (runs[state] != CharClass::NONE) {
+            const size_t run = span(runs[state], cursor, end);
+            if (run > 0) {
+                cursor += run;
+                continue;
+            }
+        }
+        state = transitions[state][static_cast<unsigned char>(*cursor++)];
+        if (state == 0) break;
+    }
+    return result;
+}
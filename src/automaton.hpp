@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+using std::array;
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+
+#include "scan.hpp"
+
+
+/*
+ * Deterministic automaton compiled once from a prioritized list of patterns.
+ * Supported syntax: literals, escapes (\d \w \s \n \t), classes [a-z] [^ ],
+ * groups, alternation and the quantifiers + * ? {n} {n,m}.
+ *
+ * A match reports the first pattern (in list order) that matches a prefix of
+ * the input together with its longest match, which is what trying every
+ * pattern in turn with a greedy regex did.
+ */
+class Automaton {
+public:
+    static const unsigned int NO_RULE = ~0u;
+
+    struct Match {
+        unsigned int rule = NO_RULE;
+        unsigned int length = 0;
+        /* input ended while a longer or better match was still possible */
+        bool partial = false;
+
+        bool isEmpty() const { return rule == NO_RULE; }
+    };
+
+private:
+    /* state 0 is the dead state */
+    vector<array<unsigned int, 256>> transitions;
+    /* highest priority rule accepted in a state */
+    vector<unsigned int> accepts;
+    /* highest priority rule accepted in any state reachable from a state */
+    vector<unsigned int> reaches;
+    /* class of bytes a state loops on, skipped with span() in one go */
+    vector<CharClass> runs;
+
+public:
+    explicit Automaton(const vector<string>& patterns);
+    ~Automaton() = default;
+
+    Match match(const char* begin, const char* end) const;
+    size_t size() const { return transitions.size(); }
+};
@@ -1,10 +1,99 @@
 #pragma once
 
-#include <vector>
+#include <cstdint>
 
 #include "lexer.hpp"
 
 
-class Alternative {
-    std::vector<Tag> prefix;
+/*
+ * Sets of tags as bit masks, the lookahead of predictive parsing. Tags past
+ * 30 share the last bit, so a set holding one of them may hold the others.
+ */
+using TagSet = uint32_t;
+
+constexpr TagSet NO_TAGS = 0;
+constexpr TagSet ANY_TAG = ~NO_TAGS;
+
+constexpr TagSet tagSet(const Tag tag) {
+    return static_cast<unsigned>(tag) < 31 ?
+        TagSet(1) << static_cast<unsigned>(tag) : TagSet(1) << 31;
+}
+
+constexpr bool contains(const TagSet set, const Tag tag) {
+    return (set & tagSet(tag)) != NO_TAGS;
 }
+
+
+/*
+ * What a rule may start with: the tags of its first lexem, the tags of the
+ * lexem after that one, whether it may match nothing and whether it always
+ * matches a single lexem. The sets may be larger than the exact ones, never
+ * smaller.
+ */
+template<typename Rule> struct Alternative {
+    static constexpr TagSet first() { return Rule::first(); }
+    static constexpr TagSet second() { return Rule::second(); }
+    static constexpr bool nullable() { return Rule::nullable(); }
+    static constexpr bool single() { return Rule::single(); }
+};
+
+
+/* the rule or nothing, once or repeated */
+template<typename Rule> struct Optional {
+    static constexpr TagSet first() { return Rule::first(); }
+    static constexpr TagSet second() { return ANY_TAG; }
+    static constexpr bool nullable() { return true; }
+    static constexpr bool single() { return false; }
+};
+
+
+/* the rules one after the other */
+template<typename... Rules> struct Sequence {
+    static constexpr TagSet first() { return NO_TAGS; }
+    static constexpr TagSet second() { return ANY_TAG; }
+    static constexpr bool nullable() { return true; }
+    static constexpr bool single() { return false; }
+};
+
+template<typename Rule, typename... Rest> struct Sequence<Rule, Rest...> {
+    using Tail = Sequence<Rest...>;
+
+    static constexpr TagSet first() {
+        return Rule::first() | (Rule::nullable() ? Tail::first() : NO_TAGS);
+    }
+    static constexpr TagSet second() {
+        return Rule::nullable() ? ANY_TAG :
+            !Rule::single() ? Rule::second() :
+            Tail::nullable() ? ANY_TAG : Tail::first();
+    }
+    static constexpr bool nullable() {
+        return Rule::nullable() && Tail::nullable();
+    }
+    static constexpr bool single() {
+        return sizeof...(Rest) == 0 && Rule::single();
+    }
+};
+
+
+/* any one of the rules */
+template<typename... Rules> struct Choice {
+    static constexpr TagSet first() { return NO_TAGS; }
+    static constexpr TagSet second() { return NO_TAGS; }
+    static constexpr bool nullable() { return false; }
+    static constexpr bool single() { return true; }
+};
+
+template<typename Rule, typename... Rest> struct Choice<Rule, Rest...> {
+    using Tail = Choice<Rest...>;
+
+    static constexpr TagSet first() { return Rule::first() | Tail::first(); }
+    static constexpr TagSet second() {
+        return Rule::second() | Tail::second();
+    }
+    static constexpr bool nullable() {
+        return Rule::nullable() || Tail::nullable();
+    }
+    static constexpr bool single() {
+        return Rule::single() && Tail::single();
+    }
+};
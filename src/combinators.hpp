@@ -0,0 +1,306 @@
+#pragma once
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+using std::vector;
+
+#include "arena.hpp"
+#include "aux.hpp"
+#include "lexer.hpp"
+
+
+class BaseAST;
+class FlatAST;
+
+using CLIter = typename vector<Lexem>::const_iterator;
+
+
+/*
+ * Parser combinators composed at compile time. A rule is an empty value type
+ * with a non virtual
+ *
+ *     Result<Value> parse(CLIter begin, CLIter end, ParseState&) const
+ *
+ * so a grammar built from them is inlined into straight code: no parser
+ * objects are allocated and nothing is dispatched at run time. A failed rule
+ * reports success == false and consumes nothing; rules never throw, the
+ * lexems they wanted are left in ParseState::expect.
+ *
+ * Every rule also states what it may start with, see Alternative of aux.hpp.
+ * Alt only tries the alternatives the next two lexems allow, so a grammar
+ * that is LL(2) is parsed without a failed attempt.
+ *
+ * Recursive rules are named structs declaring `Value`, `parse` and those
+ * lookahead facts, defined out of line in terms of the combinators.
+ */
+namespace Grammar {
+
+template<typename Value> struct Result {
+    CLIter cursor;
+    bool success = false;
+    Value value = Value();
+};
+
+
+/* alternatives Alt tried and those of them that failed */
+struct Counters {
+    size_t attempts = 0;
+    size_t failures = 0;
+};
+
+
+/* shared by every rule of one parse */
+struct ParseState {
+    /* nodes and vectors go to the heap without one */
+    Arena* arena = nullptr;
+    /* where a flat parse appends its nodes */
+    FlatAST* tree = nullptr;
+    Counters* counters = nullptr;
+    /* Alt tries every alternative in turn without it */
+    bool predictive = true;
+
+    /* groups and calls an expression may nest, any number with 0 */
+    size_t depthLimit = 0;
+    /* the lexem opening a group or call past that limit */
+    bool tooDeep = false;
+    CLIter tooDeepAt;
+
+    /* the furthest lexem a rule failed at and the tags wanted there */
+    CLIter furthest;
+    TagSet expected = NO_TAGS;
+
+    void expect(const CLIter at, const TagSet tags) {
+        if (expected == NO_TAGS || at > furthest) {
+            furthest = at;
+            expected = tags;
+        } else if (at == furthest) {
+            expected |= tags;
+        }
+    }
+};
+
+/*
+ * Values a rule built and then gave up, because a later part of a sequence
+ * failed. Heap nodes are deleted, arena nodes go with their arena and flat
+ * nodes stay in their tree; lexems and flags own nothing.
+ */
+template<typename Value> void discard(Value&, ParseState&) {}
+void discard(BaseAST*&, ParseState&);
+template<typename Item>
+void discard(vector<Item, ArenaAllocator<Item>>&, ParseState&);
+template<typename... Values> void discard(std::tuple<Values...>&, ParseState&);
+
+template<typename Item>
+void discard(vector<Item, ArenaAllocator<Item>>& items, ParseState& s) {
+    for (Item& item: items) discard(item, s);
+    items.clear();
+}
+
+template<typename Tuple, size_t... I>
+void discardEach(Tuple& values, ParseState& s, std::index_sequence<I...>) {
+    using Each = int[];
+    (void)Each{0, (discard(std::get<I>(values), s), 0)...};
+}
+
+template<typename... Values>
+void discard(std::tuple<Values...>& values, ParseState& s) {
+    discardEach(values, s, std::index_sequence_for<Values...>());
+}
+
+
+template<typename Value>
+Result<Value> fail(const CLIter begin) {
+    Result<Value> result;
+    result.cursor = begin;
+    return result;
+}
+
+template<typename Value>
+Result<Value> accept(const CLIter cursor, Value value) {
+    Result<Value> result;
+    result.cursor = cursor;
+    result.success = true;
+    result.value = std::move(value);
+    return result;
+}
+
+
+/* whether Rule may match at begin, judged by at most two lexems */
+template<typename Rule>
+bool predicts(const CLIter begin, const CLIter end, ParseState& s) {
+    constexpr TagSet first = Rule::first(), second = Rule::second();
+    if (!s.predictive || Rule::nullable()) return true;
+    if (begin == end || !contains(first, begin->getTag())) {
+        s.expect(begin, first);
+        return false;
+    }
+    /* a rule that knows its second lexem needs one */
+    if (second == ANY_TAG) return true;
+    if (begin + 1 != end && contains(second, (begin + 1)->getTag()))
+        return true;
+    s.expect(begin + 1, second);
+    return false;
+}
+
+/* Rule when the lookahead allows it, counted as an alternative */
+template<typename Rule> Result<typename Rule::Value> attempt(
+    const CLIter begin, const CLIter end, ParseState& s
+) {
+    if (!predicts<Rule>(begin, end, s))
+        return fail<typename Rule::Value>(begin);
+    if (s.counters != nullptr) ++s.counters->attempts;
+    auto result = Rule().parse(begin, end, s);
+    if (!result.success && s.counters != nullptr) ++s.counters->failures;
+    return result;
+}
+
+
+/* always matches without consuming anything */
+struct Empty : Sequence<> {
+    using Value = bool;
+
+    Result<Value> parse(CLIter begin, CLIter, ParseState&) const {
+        return accept(begin, true);
+    }
+};
+
+
+/* a single lexem with the given tag */
+template<Tag tag> struct Tagged {
+    using Value = const Lexem*;
+
+    static constexpr TagSet first() { return tagSet(tag); }
+    static constexpr TagSet second() { return ANY_TAG; }
+    static constexpr bool nullable() { return false; }
+    static constexpr bool single() { return true; }
+
+    Result<Value> parse(CLIter begin, CLIter end, ParseState& s) const {
+        if (begin == end || begin->getTag() != tag) {
+            s.expect(begin, first());
+            return fail<Value>(begin);
+        }
+        return accept(begin + 1, &*begin);
+    }
+};
+
+
+/* a keyword lexem spelled as KEYWORDS[word] */
+template<Keyword word> struct Reserved : Alternative<Tagged<Tag::KEYWORD>> {
+    using Value = const Lexem*;
+
+    Result<Value> parse(CLIter begin, CLIter end, ParseState& s) const {
+        if (begin == end || begin->getTag() != Tag::KEYWORD ||
+            begin->getContent() != KEYWORDS[static_cast<size_t>(word)]) {
+                s.expect(begin, first());
+                return fail<Value>(begin);
+        }
+        return accept(begin + 1, &*begin);
+    }
+};
+
+
+/* every rule in turn, the values are collected into a tuple */
+template<typename... Rules> struct Seq : Sequence<Rules...> {
+    using Value = std::tuple<typename Rules::Value...>;
+
+    Result<Value> parse(CLIter begin, CLIter end, ParseState& s) const {
+        Value value;
+        CLIter cursor = begin;
+        if (!step<0, Rules...>(value, cursor, end, s)) {
+            /* the rules that matched before the failing one */
+            discard(value, s);
+            return fail<Value>(begin);
+        }
+        return accept(cursor, std::move(value));
+    }
+
+private:
+    template<size_t>
+    bool step(Value&, CLIter&, CLIter, ParseState&) const {
+        return true;
+    }
+
+    template<size_t I, typename Rule, typename... Rest> bool step(
+        Value& value, CLIter& cursor, CLIter end, ParseState& s
+    ) const {
+        auto part = Rule().parse(cursor, end, s);
+        if (!part.success) return false;
+        std::get<I>(value) = std::move(part.value);
+        cursor = part.cursor;
+        return step<I + 1, Rest...>(value, cursor, end, s);
+    }
+};
+
+
+/* the first rule that matches, all rules produce the same value type */
+template<typename First, typename... Rest>
+struct Alt : Choice<First, Rest...> {
+    using Value = typename First::Value;
+    static_assert(std::is_same<Value, typename Alt<Rest...>::Value>::value,
+        "alternatives must produce the same value");
+
+    Result<Value> parse(CLIter begin, CLIter end, ParseState& s) const {
+        Result<Value> result = attempt<First>(begin, end, s);
+        return result.success ? result : Alt<Rest...>().parse(begin, end, s);
+    }
+};
+
+template<typename Rule> struct Alt<Rule> : Choice<Rule> {
+    using Value = typename Rule::Value;
+
+    Result<Value> parse(CLIter begin, CLIter end, ParseState& s) const {
+        return attempt<Rule>(begin, end, s);
+    }
+};
+
+
+/* always matches, the value is default constructed when the rule did not */
+template<typename Rule> struct Opt : Optional<Rule> {
+    using Value = typename Rule::Value;
+
+    Result<Value> parse(CLIter begin, CLIter end, ParseState& s) const {
+        Result<Value> result = Rule().parse(begin, end, s);
+        return result.success ? result : accept(begin, Value());
+    }
+};
+
+
+/* zero or more rules, a separator is consumed only when a rule follows it */
+template<typename Rule, typename Separator=Empty>
+struct Rep : Optional<Rule> {
+    using Item = typename Rule::Value;
+    using Value = vector<Item, ArenaAllocator<Item>>;
+
+    Result<Value> parse(CLIter begin, CLIter end, ParseState& s) const {
+        Value value{ArenaAllocator<Item>(s.arena)};
+        auto item = Rule().parse(begin, end, s);
+        CLIter cursor = begin;
+        while (item.success) {
+            value.push_back(std::move(item.value));
+            cursor = item.cursor;
+
+            const auto separator = Separator().parse(cursor, end, s);
+            if (!separator.success) break;
+            item = Rule().parse(separator.cursor, end, s);
+        }
+        return accept(cursor, std::move(value));
+    }
+};
+
+
+/* the value of a rule passed through Action()(value, state) */
+template<typename Rule, typename Action> struct Map : Alternative<Rule> {
+    using Value = decltype(std::declval<const Action&>()(
+        std::declval<typename Rule::Value>(),
+        std::declval<ParseState&>()));
+
+    Result<Value> parse(CLIter begin, CLIter end, ParseState& s) const {
+        auto result = Rule().parse(begin, end, s);
+        if (!result.success) return fail<Value>(begin);
+        return accept(result.cursor, Action()(std::move(result.value), s));
+    }
+};
+
+}
@@ -1,4 +1,9 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
 #include <exception>
+#include <string>
 
 
 class SyntaxError : public std::exception {
@@ -11,11 +16,68 @@ public:
 };
 
 
+enum class ParseErrorCode : uint8_t {
+    NONE,
+    /* no rule takes the lexem */
+    UNEXPECTED_LEXEM,
+    /* the lexems end inside a statement */
+    UNEXPECTED_END,
+    /* a complete statement is followed by more on its line */
+    TRAILING_LEXEMS,
+    /* groups and calls nest deeper than the parser allows */
+    TOO_DEEP,
+};
+
+
 class ParseError final : public std::exception {
+    ParseErrorCode code = ParseErrorCode::UNEXPECTED_LEXEM;
+    /* into the source, where the failing lexem starts */
+    size_t offset = 0;
+
 public:
     ParseError() = default;
+    ParseError(const ParseErrorCode c, const size_t o) : code(c), offset(o) {}
+
+    ParseErrorCode getCode() const { return code; }
+    size_t getOffset() const { return offset; }
 
     virtual const char* what() {
         return "ParseError";
     }
 };
+
+
+/* a statement with no IR, a name nobody assigned for one, or invalid IR */
+class CodegenError final : public std::exception {
+    /* of the statement, or the verifier's findings for the module */
+    size_t statement = 0;
+    std::string message;
+
+public:
+    CodegenError() = default;
+    CodegenError(const size_t s, std::string m) :
+        statement(s), message(std::move(m)) {}
+
+    size_t getStatement() const { return statement; }
+    const std::string& getMessage() const { return message; }
+
+    virtual const char* what() {
+        return "CodegenError";
+    }
+};
+
+
+/* what LLVM reported when a module could not be compiled or looked up */
+class JitError final : public std::exception {
+    std::string message;
+
+public:
+    JitError() = default;
+    explicit JitError(std::string m) : message(std::move(m)) {}
+
+    const std::string& getMessage() const { return message; }
+
+    virtual const char* what() {
+        return "JitError";
+    }
+};
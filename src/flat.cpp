@@ -0,0 +1,167 @@
+#include <cassert>
+
+#include "flat.hpp"
+#include "visitor.hpp"
+
+
+const NodeId FlatAST::NO_NODE;
+
+NodeId FlatAST::add(
+    const NodeKind kind, const OpCode code, const uint32_t a, const uint32_t b
+) {
+    assert(kinds.size() < NO_NODE);
+    kinds.push_back(kind);
+    codes.push_back(code);
+    first.push_back(a);
+    second.push_back(b);
+    return kinds.size() - 1;
+}
+
+NodeId FlatAST::integer(const int value) {
+    return add(NodeKind::INTEGER, OpCode::UNKNOWN,
+        static_cast<uint32_t>(value), 0);
+}
+
+NodeId FlatAST::name(const Symbol symbol) {
+    return add(NodeKind::NAME, OpCode::UNKNOWN, symbol.getId(), 0);
+}
+
+NodeId FlatAST::binary(const OpCode code, const NodeId lhs, const NodeId rhs) {
+    return add(NodeKind::BINARY, code, lhs, rhs);
+}
+
+NodeId FlatAST::call(const Symbol symbol, llvm::ArrayRef<NodeId> arguments) {
+    const uint32_t list = lists.size();
+    lists.push_back(arguments.size());
+    lists.insert(lists.end(), arguments.begin(), arguments.end());
+    return add(NodeKind::CALL, OpCode::UNKNOWN, symbol.getId(), list);
+}
+
+NodeId FlatAST::assign(const Symbol symbol, const NodeId value) {
+    return add(NodeKind::ASSIGN, OpCode::UNKNOWN, symbol.getId(), value);
+}
+
+size_t FlatAST::getBytes() const {
+    return kinds.capacity() * sizeof(NodeKind) +
+        codes.capacity() * sizeof(OpCode) +
+        (first.capacity() + second.capacity()) * sizeof(uint32_t) +
+        (lists.capacity() + roots.capacity()) * sizeof(NodeId);
+}
+
+
+string FlatAST::str(const NodeId node) const {
+    string out;
+    print(node, out);
+    return out;
+}
+
+void FlatAST::print(const NodeId node, string& out) const {
+    /* a node to expand or a piece of text, so deep trees need no recursion */
+    struct Item {
+        NodeId node;
+        const char* text;
+    };
+    vector<Item> stack = {{node, nullptr}};
+
+    while (!stack.empty()) {
+        const Item item = stack.back();
+        stack.pop_back();
+        if (item.text != nullptr) {
+            out += item.text;
+            continue;
+        }
+
+        const NodeId current = item.node;
+        switch (kinds[current]) {
+            case NodeKind::INTEGER:
+                out += "[IntegerAST: ";
+                out += std::to_string(getValue(current));
+                out += "]";
+                break;
+            case NodeKind::NAME:
+                out += "[Name: ";
+                out += getSymbol(current).str();
+                out += " of [IntegerType]]";
+                break;
+            case NodeKind::BINARY:
+                out += "[BinaryInstrAST: ";
+                out += OPERATORS[static_cast<size_t>(codes[current])].spelling;
+                out += " ";
+                stack.push_back({NO_NODE, "]"});
+                stack.push_back({getRight(current), nullptr});
+                stack.push_back({NO_NODE, " "});
+                stack.push_back({getLeft(current), nullptr});
+                break;
+            case NodeKind::CALL: {
+                out += "[CallInstrAST: '";
+                out += getSymbol(current).str();
+                out += "' (";
+                stack.push_back({NO_NODE, ")]"});
+                const llvm::ArrayRef<NodeId> arguments = getArguments(current);
+                for (size_t i = arguments.size(); i > 0; --i) {
+                    stack.push_back({arguments[i - 1], nullptr});
+                    if (i > 1) stack.push_back({NO_NODE, ", "});
+                }
+                break;
+            }
+            case NodeKind::ASSIGN:
+                out += "[AssignInstrAST: ";
+                out += getSymbol(current).str();
+                out += " = ";
+                stack.push_back({NO_NODE, "]"});
+                stack.push_back({getValueNode(current), nullptr});
+                break;
+            case NodeKind::PROTOTYPE:
+            case NodeKind::RETURN:
+            case NodeKind::IF:
+            case NodeKind::WHILE:
+            case NodeKind::FUNCTION:
+                /* never made flat */
+                break;
+        }
+    }
+}
+
+
+llvm::Value* FlatAST::codegen(const NodeId node, Session& session) const {
+    CodegenVisitor visitor(session);
+    return codegen(node, visitor);
+}
+
+llvm::Value* FlatAST::codegen(
+    const NodeId node, CodegenVisitor& visitor
+) const {
+    switch (kinds[node]) {
+        case NodeKind::INTEGER:
+            return visitor.integer(getValue(node));
+        case NodeKind::NAME:
+            return visitor.load(getSymbol(node));
+        case NodeKind::BINARY:
+            return visitor.binary(codes[node],
+                codegen(getLeft(node), visitor),
+                codegen(getRight(node), visitor));
+        case NodeKind::CALL: {
+            const Symbol symbol = getSymbol(node);
+            const llvm::ArrayRef<NodeId> list = getArguments(node);
+            llvm::Function* function = visitor.callee(symbol, list.size());
+            if (function == nullptr) return nullptr;
+
+            vector<llvm::Value*> arguments;
+            for (const NodeId argument: list) {
+                arguments.push_back(codegen(argument, visitor));
+                if (arguments.back() == nullptr) return nullptr;
+            }
+            return visitor.call(function, arguments);
+        }
+        case NodeKind::ASSIGN:
+            return visitor.store(getSymbol(node),
+                codegen(getValueNode(node), visitor));
+        case NodeKind::PROTOTYPE:
+        case NodeKind::RETURN:
+        case NodeKind::IF:
+        case NodeKind::WHILE:
+        case NodeKind::FUNCTION:
+            break;
+    }
+    return nullptr;
+}
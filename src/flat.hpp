@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/IR/Value.h>
+
+#include "lexer.hpp"
+#include "session.hpp"
+
+
+class CodegenVisitor;
+
+
+using NodeId = uint32_t;
+
+
+/*
+ * The AST as parallel arrays addressed by 32 bit handles. Every node is a
+ * kind byte, an operator byte and two words:
+ *
+ *     INTEGER  value
+ *     NAME     symbol
+ *     BINARY   lhs, rhs       and its OpCode
+ *     CALL     symbol, list   where lists[list] is the argument count
+ *                             followed by the arguments
+ *     ASSIGN   symbol, value
+ *
+ * Children are added before their parents, so a node's handle is larger
+ * than the handles below it and a pass over the arrays in order visits
+ * children first.
+ */
+class FlatAST {
+public:
+    static const NodeId NO_NODE = ~0u;
+
+private:
+    vector<NodeKind> kinds;
+    vector<OpCode> codes;
+    vector<uint32_t> first;
+    vector<uint32_t> second;
+    vector<NodeId> lists;
+    vector<NodeId> roots;
+
+public:
+    FlatAST() = default;
+    FlatAST(const FlatAST&) = delete;
+    FlatAST& operator = (const FlatAST&) = delete;
+
+    NodeId integer(const int value);
+    NodeId name(const Symbol symbol);
+    NodeId binary(const OpCode code, const NodeId lhs, const NodeId rhs);
+    NodeId call(const Symbol symbol, llvm::ArrayRef<NodeId> arguments);
+    NodeId assign(const Symbol symbol, const NodeId value);
+    void addRoot(const NodeId node) { roots.push_back(node); }
+
+    size_t size() const { return kinds.size(); }
+    /* bytes held by the arrays, spare capacity included */
+    size_t getBytes() const;
+    llvm::ArrayRef<NodeId> getRoots() const { return roots; }
+
+    NodeKind getKind(const NodeId node) const { return kinds[node]; }
+    OpCode getOpCode(const NodeId node) const { return codes[node]; }
+    int getValue(const NodeId node) const {
+        return static_cast<int>(first[node]);
+    }
+    Symbol getSymbol(const NodeId node) const { return Symbol(first[node]); }
+    NodeId getLeft(const NodeId node) const { return first[node]; }
+    NodeId getRight(const NodeId node) const { return second[node]; }
+    NodeId getValueNode(const NodeId node) const { return second[node]; }
+    llvm::ArrayRef<NodeId> getArguments(const NodeId node) const {
+        return llvm::ArrayRef<NodeId>(
+            lists.data() + second[node] + 1, lists[second[node]]);
+    }
+
+    /* the text BaseAST::str() gives for the same tree */
+    string str(const NodeId node) const;
+    void print(const NodeId node, string& out) const;
+    /* the IR the tree codegen makes for the same nodes, where it would */
+    llvm::Value* codegen(const NodeId node, Session&) const;
+
+private:
+    NodeId add(NodeKind, OpCode, uint32_t, uint32_t);
+    llvm::Value* codegen(const NodeId node, CodegenVisitor&) const;
+};
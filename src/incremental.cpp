@@ -0,0 +1,295 @@
+#include <stdexcept>
+
+#include "incremental.hpp"
+
+
+const size_t IncrementalUnit::PAGE_LINES;
+
+IncrementalUnit::IncrementalUnit(const Lexer& l, StringRef source) :
+    lexer(l), pages(1) {
+    index();
+    edit(0, 0, source);
+}
+
+IncrementalUnit::Change IncrementalUnit::edit(
+    size_t offset, size_t removed, StringRef inserted
+) {
+    const Position from = locate(offset);
+    const Position to = locate(offset + removed);
+    const Page& head = pages[from.page];
+    const Page& tail = pages[to.page];
+    const size_t line = lines.before(from.page) + from.index;
+
+    /* the touched lines glued back together around the new text */
+    string text;
+    if (from.index < head.lines.size())
+        text.append(head.lines[from.index]->text, 0, from.column);
+    text.append(inserted.data(), inserted.size());
+    if (to.index < tail.lines.size())
+        text.append(tail.lines[to.index]->text, to.column, string::npos);
+
+    /*
+     * widened to whole statements: the lines of a body after the edit may
+     * be lexed at other levels now, and the statement before takes the new
+     * lines in when they open none of their own
+     */
+    size_t last = std::min(lines.before(to.page) + to.index + 1, count);
+    for (; last < count && getLine(last).span == 0; ++last)
+        text += getLine(last).text;
+    size_t first = line;
+    if (first > 0 && (first == count || getLine(first).span > 0) &&
+        !text.empty() && !opensStatement(text))
+            --first;
+    while (first > 0 && first < count && getLine(first).span == 0)
+        --first;
+    string before;
+    for (size_t i = first; i < line; ++i) before += getLine(i).text;
+    text.insert(0, before);
+
+    vector<unique_ptr<Line>> built;
+    for (size_t start = 0; start < text.size(); ) {
+        size_t stop = text.find('\n', start);
+        stop = stop == string::npos ? text.size() : stop + 1;
+        built.push_back(unique_ptr<Line>(new Line));
+        built.back()->text = text.substr(start, stop - start);
+        start = stop;
+    }
+    for (size_t begin = 0, end; begin < built.size(); begin = end) {
+        for (end = begin + 1; end < built.size(); ++end)
+            if (opensStatement(built[end]->text)) break;
+        build(built.begin() + begin, built.begin() + end);
+    }
+
+    Change change;
+    change.line = first;
+    change.removed = last - first;
+    change.inserted = built.size();
+
+    const Position begin = at(first);
+    const Position end = at(last);
+    Page& page = pages[begin.page];
+    const size_t pageBytes = page.bytes, pageLines = page.lines.size();
+    const size_t pageCount = pages.size();
+    if (begin.page == end.page) {
+        drop(page, begin.index, end.index);
+    } else {
+        drop(page, begin.index, page.lines.size());
+        for (size_t i = begin.page + 1; i < end.page; ++i)
+            drop(pages[i], 0, pages[i].lines.size());
+        drop(pages[end.page], 0, end.index);
+    }
+
+    for (const auto& next: built) invalid += !next->valid;
+    count += built.size();
+    page.lines.insert(page.lines.begin() + begin.index,
+        std::make_move_iterator(built.begin()),
+        std::make_move_iterator(built.end()));
+
+    if (begin.page != end.page) {
+        pages.erase(pages.begin() + begin.page + 1, pages.begin() + end.page);
+        settle(begin.page + 1);
+    }
+    settle(begin.page);
+
+    /* an edit within a page moves its sums only */
+    if (pages.size() != pageCount || begin.page != end.page) {
+        index();
+    } else {
+        bytes.add(begin.page, pages[begin.page].bytes - pageBytes);
+        lines.add(begin.page, pages[begin.page].lines.size() - pageLines);
+    }
+    return change;
+}
+
+string IncrementalUnit::getSource() const {
+    size_t length = 0;
+    for (const Page& page: pages) length += page.bytes;
+
+    string source;
+    source.reserve(length);
+    for (const Page& page: pages)
+        for (const auto& line: page.lines) source += line->text;
+    return source;
+}
+
+const IncrementalUnit::Line& IncrementalUnit::getLine(size_t i) const {
+    const Position position = at(i);
+    return *pages[position.page].lines[position.index];
+}
+
+IncrementalUnit::Position IncrementalUnit::locate(size_t offset) const {
+    /* whole pages are skipped by size, nothing is lexed on the way */
+    Position position = {0, 0, 0};
+    position.page = std::min(bytes.count(offset), pages.size() - 1);
+    size_t start = bytes.before(position.page);
+
+    const auto& lines = pages[position.page].lines;
+    while (position.index < lines.size() &&
+        offset >= start + lines[position.index]->text.size()) {
+            start += lines[position.index]->text.size();
+            ++position.index;
+    }
+    if (position.index == lines.size()) {
+        if (offset > start)
+            throw std::out_of_range("edit past the end of the unit");
+        /* the end of a last line without newline still belongs to it */
+        if (!lines.empty() && lines.back()->text.back() != '\n') {
+            --position.index;
+            start -= lines.back()->text.size();
+        }
+    }
+    position.column = offset - start;
+    return position;
+}
+
+IncrementalUnit::Position IncrementalUnit::at(const size_t line) const {
+    const size_t page = std::min(lines.count(line), pages.size() - 1);
+    return {page, line - lines.before(page), 0};
+}
+
+/*
+ * An else continues its if, any other line opens a statement once it is not
+ * blank and indented by less than a level, whatever the lines before it.
+ */
+bool IncrementalUnit::opensStatement(StringRef text) const {
+    const size_t start = text.find_first_not_of(' ');
+    if (start >= Lexer::INDENT_WIDTH || text[start] == '\n') return false;
+    const Automaton::Match word =
+        lexer.match(text.data() + start, text.data() + text.size());
+    return word.isEmpty() ||
+        lexer.getTag(word, text.data() + start) != Tag::KEYWORD ||
+        text.substr(start, word.length) !=
+            KEYWORDS[static_cast<size_t>(Keyword::ELSE)];
+}
+
+void IncrementalUnit::build(const LineIter begin, const LineIter end) const {
+    /* every line is lexed at the level the line before it left */
+    unsigned int level = 0;
+    bool valid = true;
+    for (LineIter line = begin; line != end; ++line) {
+        try {
+            (*line)->lexems = lexer.tokenize((*line)->text, level);
+        } catch (const SyntaxError&) {
+            (*line)->lexems.clear();
+            valid = false;
+        }
+    }
+    Line& back = **(end - 1);
+    for (; level > 0; --level)
+        back.lexems.push_back(Lexem(back.text.data(), back.text.size(),
+            back.text.size(), Tag::DEDENT));
+
+    vector<Lexem> lexems;
+    for (LineIter line = begin; line != end; ++line)
+        lexems.insert(lexems.end(),
+            (*line)->lexems.begin(), (*line)->lexems.end());
+
+    /* blank lines lead only the first statement, any may trail */
+    unique_ptr<BaseAST> statement;
+    CLIter cursor = lexems.begin();
+    while (cursor != lexems.end() && cursor->getTag() == Tag::EOL) ++cursor;
+    try {
+        if (valid && cursor != lexems.end()) {
+            const ParseResult result =
+                StatementParser().parse(cursor, lexems.end());
+            statement.reset(result.ast);
+            cursor = result.cursor;
+        }
+        while (cursor != lexems.end() && cursor->getTag() == Tag::EOL)
+            ++cursor;
+        valid = valid && cursor == lexems.end();
+    } catch (const ParseError&) {
+        valid = false;
+    }
+
+    (*begin)->statement = std::move(statement);
+    (*begin)->span = end - begin;
+    for (LineIter line = begin; line != end; ++line)
+        (*line)->valid = valid;
+}
+
+void IncrementalUnit::drop(Page& page, const size_t begin, const size_t end) {
+    for (size_t i = begin; i < end; ++i)
+        invalid -= !page.lines[i]->valid;
+    page.lines.erase(page.lines.begin() + begin, page.lines.begin() + end);
+    count -= end - begin;
+}
+
+void IncrementalUnit::settle(const size_t index) {
+    Page& page = pages[index];
+    if (page.lines.empty() && pages.size() > 1) {
+        pages.erase(pages.begin() + index);
+        return;
+    }
+
+    /* an oversized page is cut into pages of PAGE_LINES lines */
+    vector<Page> split;
+    if (page.lines.size() > 2 * PAGE_LINES) {
+        for (size_t i = PAGE_LINES; i < page.lines.size(); i += PAGE_LINES) {
+            split.emplace_back();
+            const size_t end = std::min(i + PAGE_LINES, page.lines.size());
+            for (size_t j = i; j < end; ++j) {
+                split.back().bytes += page.lines[j]->text.size();
+                split.back().lines.push_back(std::move(page.lines[j]));
+            }
+        }
+        page.lines.resize(PAGE_LINES);
+    }
+
+    page.bytes = 0;
+    for (const auto& line: page.lines) page.bytes += line->text.size();
+    pages.insert(pages.begin() + index + 1,
+        std::make_move_iterator(split.begin()),
+        std::make_move_iterator(split.end()));
+}
+
+void IncrementalUnit::index() {
+    vector<size_t> pageBytes, pageLines;
+    pageBytes.reserve(pages.size());
+    pageLines.reserve(pages.size());
+    for (const Page& page: pages) {
+        pageBytes.push_back(page.bytes);
+        pageLines.push_back(page.lines.size());
+    }
+    bytes.reset(pageBytes);
+    lines.reset(pageLines);
+}
+
+
+
+
+void IncrementalUnit::Sums::reset(const vector<size_t>& values) {
+    /* each node hands its sum on to its parent, a linear build */
+    tree.assign(values.size() + 1, 0);
+    for (size_t i = 1; i < tree.size(); ++i) {
+        tree[i] += values[i - 1];
+        const size_t parent = i + (i & -i);
+        if (parent < tree.size()) tree[parent] += tree[i];
+    }
+}
+
+void IncrementalUnit::Sums::add(size_t page, const size_t delta) {
+    for (++page; page < tree.size(); page += page & -page)
+        tree[page] += delta;
+}
+
+size_t IncrementalUnit::Sums::before(size_t page) const {
+    size_t sum = 0;
+    for (; page > 0; page -= page & -page)
+        sum += tree[page];
+    return sum;
+}
+
+size_t IncrementalUnit::Sums::count(size_t sum) const {
+    size_t step = 1;
+    while (step * 2 < tree.size()) step *= 2;
+
+    size_t pages = 0;
+    for (; step > 0; step /= 2) {
+        if (pages + step < tree.size() && tree[pages + step] <= sum) {
+            pages += step;
+            sum -= tree[pages];
+        }
+    }
+    return pages;
+}
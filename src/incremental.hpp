@@ -0,0 +1,110 @@
+#pragma once
+
+#include <memory>
+using std::unique_ptr;
+
+#include "parser.hpp"
+
+
+/*
+ * Program text kept line by line together with the lexems of every line and
+ * the top level statements. A statement spans the line opening it and the
+ * lines of its bodies, blank ones and an else included. An edit re-lexes
+ * and re-parses the statements it touches, up to the first line that opens
+ * a statement of the old text again, the rest of the unit is reused as is.
+ */
+class IncrementalUnit {
+public:
+    struct Line {
+        /* including the trailing newline, the last line may lack one */
+        string text;
+        /*
+         * views into text, offsets are relative to the line; the last line
+         * of a statement ends with the DEDENTs closing its bodies
+         */
+        vector<Lexem> lexems;
+        /* on the line opening it, nullptr for blank or broken statements */
+        unique_ptr<BaseAST> statement;
+        /* lines of the statement opened here, 0 for the lines within one */
+        size_t span = 0;
+        /* the same on every line of a statement */
+        bool valid = true;
+    };
+
+    /* lines [line, line + removed) were replaced by `inserted` new ones */
+    struct Change {
+        size_t line = 0;
+        size_t removed = 0;
+        size_t inserted = 0;
+    };
+
+private:
+    /* lines are kept in pages so that an edit shifts and sums one page */
+    static const size_t PAGE_LINES = 256;
+    struct Page {
+        /* behind pointers so that lexem views survive vector moves */
+        vector<unique_ptr<Line>> lines;
+        size_t bytes = 0;
+    };
+    using LineIter = vector<unique_ptr<Line>>::iterator;
+
+    /*
+     * Fenwick tree over a value per page, so the sum before a page and the
+     * page holding a given sum are found in log time instead of by walking
+     * the pages. Values may shrink, deltas wrap around as unsigned.
+     */
+    class Sums {
+        /* 1 based, tree[i] sums the values (i - lowbit(i), i] */
+        vector<size_t> tree;
+
+    public:
+        void reset(const vector<size_t>& values);
+        void add(size_t page, size_t delta);
+        /* the values of the pages before `page` */
+        size_t before(size_t page) const;
+        /* how many leading pages hold at most `sum` together */
+        size_t count(size_t sum) const;
+    };
+
+    struct Position {
+        size_t page;
+        size_t index;
+        size_t column;
+    };
+
+    const Lexer& lexer;
+    /* never empty, only a single page may hold no lines */
+    vector<Page> pages;
+    /* bytes and lines of the pages, kept in step with them */
+    Sums bytes;
+    Sums lines;
+    size_t count = 0;
+    size_t invalid = 0;
+
+public:
+    /* the lexer must outlive the unit */
+    explicit IncrementalUnit(const Lexer&, StringRef source="");
+    IncrementalUnit(const IncrementalUnit&) = delete;
+    IncrementalUnit& operator = (const IncrementalUnit&) = delete;
+    ~IncrementalUnit() = default;
+
+    /* replace `removed` bytes at `offset` with `inserted` */
+    Change edit(size_t offset, size_t removed, StringRef inserted);
+
+    string getSource() const;
+    size_t size() const { return count; }
+    const Line& getLine(size_t) const;
+    bool isValid() const { return invalid == 0; }
+
+private:
+    Position locate(size_t offset) const;
+    Position at(size_t line) const;
+    /* whether a line is one that opens a top level statement */
+    bool opensStatement(StringRef text) const;
+    /* lexes and parses the lines of one statement */
+    void build(LineIter begin, LineIter end) const;
+    void drop(Page&, const size_t begin, const size_t end);
+    void settle(size_t page);
+    /* the sums rebuilt after pages were added or removed */
+    void index();
+};
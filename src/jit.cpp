@@ -0,0 +1,71 @@
+#include <mutex>
+
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/TargetSelect.h>
+
+#include "jit.hpp"
+
+
+namespace {
+
+void initializeTarget() {
+    static std::once_flag once;
+    std::call_once(once, [] {
+        llvm::InitializeNativeTarget();
+        llvm::InitializeNativeTargetAsmPrinter();
+    });
+}
+
+template<typename T> T orThrow(llvm::Expected<T> value) {
+    if (!value) throw JitError(llvm::toString(value.takeError()));
+    return std::move(*value);
+}
+
+void orThrow(llvm::Error error) {
+    if (error) throw JitError(llvm::toString(std::move(error)));
+}
+
+}
+
+
+JitRunner::JitRunner() {
+    initializeTarget();
+    llvm::orc::JITTargetMachineBuilder host =
+        orThrow(llvm::orc::JITTargetMachineBuilder::detectHost());
+    target = orThrow(host.createTargetMachine());
+    jit = orThrow(llvm::orc::LLJITBuilder()
+        .setJITTargetMachineBuilder(std::move(host)).create());
+}
+
+JitRunner::~JitRunner() = default;
+
+void JitRunner::add(
+    unique_ptr<llvm::Module> module, unique_ptr<llvm::LLVMContext> context
+) {
+    module->setDataLayout(jit->getDataLayout());
+    /* known once the jit took the module, a rejected one changes nothing */
+    llvm::StringMap<unsigned int> defined;
+    for (const llvm::Function& function: *module)
+        if (!function.isDeclaration())
+            defined[function.getName()] = function.arg_size();
+    orThrow(jit->addIRModule(llvm::orc::ThreadSafeModule(
+        std::move(module), std::move(context))));
+    for (const auto& function: defined)
+        arities[function.getKey()] = function.getValue();
+}
+
+void JitRunner::add(Session& session) {
+    unique_ptr<llvm::Module> module = session.takeModule();
+    add(std::move(module), session.takeContext());
+}
+
+uint64_t JitRunner::address(StringRef name, const unsigned int arity) {
+    const auto known = arities.find(name);
+    if (known == arities.end())
+        throw JitError("no function " + name.str());
+    if (known->second != arity)
+        throw JitError(name.str() + " takes " +
+            std::to_string(known->second) + " arguments");
+    return orThrow(jit->lookup(name)).getAddress();
+}
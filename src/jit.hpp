@@ -0,0 +1,60 @@
+#pragma once
+
+#include <memory>
+using std::unique_ptr;
+#include <string>
+using std::string;
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+using llvm::StringRef;
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include "exceptions.hpp"
+#include "session.hpp"
+
+
+/*
+ * Native code of generated modules, compiled in process by an ORC LLJIT.
+ * A module added is compiled on the first lookup of one of its functions,
+ * and every function is an int over int arguments, so a `define` with n
+ * arguments is looked up as int(int, ..., int) with n ints. Failures of
+ * LLVM are thrown as JitError.
+ */
+class JitRunner {
+    /* the host, which the jit compiles for and an Optimizer may tune for */
+    unique_ptr<llvm::TargetMachine> target;
+    unique_ptr<llvm::orc::LLJIT> jit;
+    /* argument counts of the functions defined by the modules added */
+    llvm::StringMap<unsigned int> arities;
+
+public:
+    JitRunner();
+    JitRunner(const JitRunner&) = delete;
+    JitRunner& operator = (const JitRunner&) = delete;
+    ~JitRunner();
+
+    /* the module has to verify, it is owned by the jit with its context */
+    void add(unique_ptr<llvm::Module>, unique_ptr<llvm::LLVMContext>);
+    /* the module of the session, which is done after */
+    void add(Session&);
+
+    /* for Optimizer::run before add, so passes see the layout of the jit */
+    llvm::TargetMachine& getTarget() const { return *target; }
+
+    template<typename Signature> Signature* lookup(StringRef name) {
+        return reinterpret_cast<Signature*>(
+            address(name, Arity<Signature>::value));
+    }
+
+private:
+    template<typename Signature> struct Arity;
+    template<typename... Args> struct Arity<int(Args...)> {
+        static const unsigned int value = sizeof...(Args);
+    };
+
+    uint64_t address(StringRef name, const unsigned int arity);
+};
@@ -1,46 +1,45 @@
 #include <cassert>
-#include <regex>
-using std::regex;
-using std::match_results;
-using std::sub_match;
-#include <memory>
-using std::allocator;
+#include <cctype>
 #include <algorithm>
-using std::remove_if;
+#include <exception>
+#include <future>
 
 #include "lexer.hpp"
+#include "tokens.hpp"
 
 
 ostream& operator << (ostream& os, Tag tag) {
-    switch (tag) {
-        case Tag::SEPARATOR: return os << "Tag::SEPARATOR";
-        case Tag::INTEGER: return os << "Tag::INTEGER";
-        case Tag::OPERATOR: return os << "Tag::OPERATOR";
-        case Tag::BLOCK: return os << "Tag::BLOCK";
-        case Tag::EOL: return os << "Tag::EOL";
-        case Tag::KEYWORD: return os << "Tag::KEYWORD";
-        case Tag::NAME: return os << "Tag::NAME";
-        case Tag::LEFT_BRACKET: return os << "Tag::LEFT_BRACKET";
-        case Tag::RIGHT_BRACKET: return os << "Tag::RIGHT_BRACKET";
-        case Tag::COMMA: return os << "Tag::COMMA";
-        case Tag::COLON: return os << "Tag::COLON";
-        case Tag::ASSIGN: return os << "Tag::ASSIGN";
-        default: return os << "Tag::UNKNOWN";
-    }
+    for (const TagInfo& info: TAGS)
+        if (info.tag == tag) return os << info.name;
+    return os << "Tag::UNKNOWN";
+}
+
+
+Lexem::Lexem(const char* src, unsigned int s, unsigned int e, Tag t) :
+    text(src + s), start(s), length(e - s), tag(t) {
+            assert(src != nullptr);
+            assert(s < e || (s == e && t == Tag::DEDENT));
+            if (tag == Tag::NAME)
+                symbol = intern(getContent());
 }
 
+Lexem::Lexem(StringRef content, unsigned int s, Tag t) :
+    text(content.data()), start(s), length(content.size()), tag(t) {
+            assert(!content.empty() || t == Tag::DEDENT);
+            if (tag == Tag::NAME)
+                symbol = intern(getContent());
+}
 
-Lexem::Lexem(const std::string &cont, unsigned int s, unsigned int e, Tag t) :
-    content(cont), start(s), end(e), length(e - s), tag(t) {
-            assert(start < end);
-            assert(length == content.size());
-            empty = false;
+Lexem::Lexem(const char* src, unsigned int s, unsigned int e, Tag t,
+    Symbol sym) : text(src + s), start(s), length(e - s), symbol(sym), tag(t) {
+            assert(src != nullptr);
+            assert(s < e || (s == e && t == Tag::DEDENT));
 }
 
 
 ostream& operator << (ostream& os, const Lexem& lexem) {
-    return os << "[Lexem: content - '" << lexem.getContent() << "' tag - " <<
-        lexem.getTag() << "]";
+    return os << "[Lexem: content - '" << lexem.getContent().str() <<
+        "' tag - " << lexem.getTag() << "]";
 }
 
 
@@ -50,47 +49,170 @@ Token::Token(const char *_template, const Tag &_tag) :
 Token::Token(const string& _template, const Tag& _tag) :
         string_pattern(_template), tag(_tag) {}
 
-Lexem Token::match(const std::string &str, const unsigned int position) const {
-    using CIter = string::const_iterator;
-    using CAllocator = allocator<sub_match<CIter>>;
-
-    regex pattern(string_pattern);
-    match_results<CIter, CAllocator> match_r;
 
-    bool result = std::regex_search(
-        str.begin() + position, str.end(), match_r, pattern
-    );
+Lexer::Lexer() : tokens(makeTokens()), automaton(patterns(tokens)),
+    line_count(0), row_count(0) {}
+
+vector<Token> Lexer::makeTokens() {
+    const auto literal = [](const char* spelling) {
+        string pattern;
+        for (const char* c = spelling; *c != '\0'; ++c)
+            pattern += string(std::isalnum(*c) ? "" : "\\") + *c;
+        return pattern;
+    };
+
+    /* indentation is counted by the lexers, the automaton skips spaces */
+    vector<Token> result = {
+        Token("[ ]+", Tag::SEPARATOR),
+        Token("\\d+", Tag::INTEGER),
+        Token("\\n", Tag::EOL),
+        Token("\\w+", Tag::NAME),
+    };
+    /* before punctuation, so that '==' is not read as two '=' */
+    for (const OperatorInfo& op: OPERATORS)
+        result.push_back(Token(literal(op.spelling), Tag::OPERATOR));
+    for (const PunctuationInfo& punctuation: PUNCTUATION)
+        result.push_back(Token(literal(punctuation.spelling), punctuation.tag));
+    return result;
+}
 
-    return result && match_r.position() == 0 ?
-        Lexem(match_r.str(), position, position + match_r.length(), tag) :
-        Lexem();
+vector<string> Lexer::patterns(const vector<Token>& tokens) {
+    vector<string> result;
+    for (const Token& token: tokens)
+        result.push_back(token.getPattern());
+    return result;
 }
 
+vector<Lexem> Lexer::tokenize(const string& str) const throw(SyntaxError) {
+    vector<Lexem> lexems = {};
+    tokenize(str, 0, str.size(), lexems);
+    return lexems;
+}
 
-Lexer::Lexer() : line_count(0), row_count(0) {}
+void Lexer::tokenize(const string& str, TokenBuffer& tokens) const
+    throw(SyntaxError) {
+    tokens = TokenBuffer(str);
+    tokenize(str, 0, str.size(), tokens);
+}
 
-vector<Lexem> Lexer::tokenize(const string& str) const throw(SyntaxError) {
-    const unsigned int length = str.size();
-    unsigned int position = 0;
+vector<Lexem> Lexer::tokenize(const string& line, unsigned int& level) const
+    throw(SyntaxError) {
     vector<Lexem> lexems = {};
+    tokenize(line, 0, line.size(), level, lexems);
+    return lexems;
+}
 
-    if (length == 0) return lexems;
+vector<Lexem> Lexer::tokenize(
+    const string& str, llvm::ThreadPool& pool, const size_t minChunk
+) const throw(SyntaxError) {
+    /*
+     * Only EOL contains a newline, so every line starts a fresh lexem and
+     * chunks ending right after a newline lex exactly as the whole text,
+     * once each starts at the level of the last non blank line before it.
+     */
+    const size_t chunks = std::max<size_t>(1, std::min<size_t>(
+        pool.getThreadCount() * 4, str.size() / std::max<size_t>(minChunk, 1)
+    ));
+    vector<unsigned int> bounds = {0};
+    for (size_t i = 1; i < chunks; ++i) {
+        const size_t newline = str.find('\n', str.size() / chunks * i);
+        if (newline == string::npos) break;
+        if (newline + 1 > bounds.back() && newline + 1 < str.size())
+            bounds.push_back(newline + 1);
+    }
+    bounds.push_back(str.size());
+
+    /* pool threads can not throw, errors are handed over to this one */
+    vector<vector<Lexem>> parts(bounds.size() - 1);
+    vector<std::exception_ptr> errors(parts.size());
+    vector<std::shared_future<void>> done;
+    for (size_t i = 0; i < parts.size(); ++i) {
+        done.push_back(pool.async([&, i] {
+            try {
+                tokenize(str, bounds[i], bounds[i + 1], parts[i]);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }));
+    }
+    for (auto& part: done)
+        part.wait();
+    for (const std::exception_ptr& error: errors)
+        if (error) std::rethrow_exception(error);
+
+    size_t total = 0;
+    for (const vector<Lexem>& part: parts)
+        total += part.size();
+    vector<Lexem> lexems;
+    lexems.reserve(total);
+    for (const vector<Lexem>& part: parts)
+        lexems.insert(lexems.end(), part.begin(), part.end());
+    return lexems;
+}
+
+template<typename Output> void Lexer::tokenize(const string& str,
+    const unsigned int begin, const unsigned int end, Output& lexems) const {
+    /* begin is always at the start of a line */
+    unsigned int level = levelBefore(str, begin);
+    tokenize(str, begin, end, level, lexems);
+    if (end == str.size())
+        for (; level > 0; --level)
+            lexems.push_back(Lexem(str.data(), end, end, Tag::DEDENT));
+}
 
-    while (position < length) {
-        const Lexem lex = findLexem(str, position);
+template<typename Output> void Lexer::tokenize(const string& str,
+    const unsigned int begin, const unsigned int end, unsigned int& level,
+    Output& lexems) const {
+    bool lineStart = true;
+    unsigned int position = begin;
+
+    while (position < end) {
+        if (str[position] == ' ' || lineStart) {
+            const unsigned int run = span(CharClass::SPACE,
+                str.data() + position, str.data() + end);
+            const unsigned int content = position + run;
+            if (lineStart && content < end && str[content] != '\n') {
+                const unsigned int target = run / INDENT_WIDTH;
+                for (; level < target; ++level)
+                    lexems.push_back(Lexem(str.data(),
+                        position + level * INDENT_WIDTH,
+                        position + (level + 1) * INDENT_WIDTH, Tag::INDENT));
+                for (; level > target; --level)
+                    lexems.push_back(
+                        Lexem(str.data(), content, content, Tag::DEDENT));
+            }
+            lineStart = false;
+            position = content;
+            continue;
+        }
+        const Lexem lex = findLexem(str, position, end);
         position += lex.getLength();
+        lineStart = lex.getTag() == Tag::EOL;
         if (lex.getTag() != Tag::SEPARATOR)
             lexems.push_back(lex);
     }
-    return lexems;
 }
 
-Lexem Lexer::findLexem(const string& str, const unsigned int position) const {
-    for (const Token& token: tokens) {
-        Lexem match_result = token.match(str, position);
-        if (!match_result.isEmpty()) {
-            return match_result;
-        }
+unsigned int Lexer::levelBefore(const string& str, unsigned int line) {
+    /* the lines before, last one first, up to one that is not blank */
+    while (line > 0) {
+        const size_t start = line > 1 ? str.rfind('\n', line - 2) + 1 : 0;
+        const unsigned int run = span(CharClass::SPACE,
+            str.data() + start, str.data() + line);
+        if (str[start + run] != '\n') return run / INDENT_WIDTH;
+        line = start;
     }
-    throw SyntaxError();
+    return 0;
+}
+
+Lexem Lexer::findLexem(const string& str,
+    const unsigned int position, const unsigned int end) const {
+    const Automaton::Match found = match(
+        str.data() + position, str.data() + end
+    );
+    if (found.isEmpty() || found.length == 0)
+        throw SyntaxError();
+
+    return Lexem(str.data(), position, position + found.length,
+        getTag(found, str.data() + position));
 }
@@ -8,19 +8,28 @@ using std::ostream;
 using std::array;
 #include <vector>
 using std::vector;
+#include <cstring>
+#include <cstdint>
 
+#include <llvm/ADT/StringRef.h>
+using llvm::StringRef;
+#include <llvm/Support/ThreadPool.h>
+
+#include "automaton.hpp"
 #include "exceptions.hpp"
+#include "symbol.hpp"
 
 
 enum class Tag : unsigned short int {
     SEPARATOR = 0,      //[ ]
     INTEGER = 1,        //\d+
     OPERATOR = 2,       //+, -, /, ...
-    BLOCK = 4,          /* define add(a, b):
-                        [    ]return a + b */
+    INDENT = 4,         /* define add(a, b):
+                        [    ]return a + b, one per level opened */
     EOL = 5,            //\n
     KEYWORD = 6,        //define, if, else, ...
     NAME = 7,           //\w+
+    DEDENT = 8,         //empty, one per level closed
     LEFT_BRACKET = 9,   //(
     RIGHT_BRACKET = 10, //)
     COMMA = 11,         //,
@@ -31,24 +40,214 @@ enum class Tag : unsigned short int {
 
 ostream& operator << (ostream& os, Tag tag);
 
+
+/*
+ * Compile time token tables: the lexer's patterns, keyword lookup, operator
+ * codes and weights, and tag names are all derived from them.
+ */
+enum class OpCode : unsigned short int {
+    ADD = 0,
+    SUB = 1,
+    MUL = 2,
+    DIV = 3,
+    EQ = 4,
+    UNKNOWN = 255
+};
+
+enum class Assoc { LEFT, RIGHT };
+
+/* what an AST node is, BaseAST and FlatAST alike */
+enum class NodeKind : uint8_t {
+    INTEGER, NAME, BINARY, CALL, ASSIGN, PROTOTYPE, RETURN, IF, WHILE, FUNCTION
+};
+
+struct OperatorInfo {
+    const char* spelling;
+    OpCode code;
+    /* binds tighter the higher it is */
+    unsigned short int weight;
+    Assoc assoc;
+};
+
+/* indexed by OpCode */
+constexpr OperatorInfo OPERATORS[] = {
+    {"+", OpCode::ADD, 1, Assoc::LEFT},
+    {"-", OpCode::SUB, 1, Assoc::LEFT},
+    {"*", OpCode::MUL, 2, Assoc::LEFT},
+    {"/", OpCode::DIV, 2, Assoc::LEFT},
+    {"==", OpCode::EQ, 0, Assoc::LEFT},
+};
+
+struct PunctuationInfo {
+    const char* spelling;
+    Tag tag;
+};
+
+constexpr PunctuationInfo PUNCTUATION[] = {
+    {",", Tag::COMMA},
+    {":", Tag::COLON},
+    {"(", Tag::LEFT_BRACKET},
+    {")", Tag::RIGHT_BRACKET},
+    {"=", Tag::ASSIGN},
+};
+
+constexpr const char* KEYWORDS[] = {
+    "define", "while", "if", "else", "return", "declare",
+};
+
+/* indexes into KEYWORDS */
+enum class Keyword : unsigned char {
+    DEFINE, WHILE, IF, ELSE, RETURN, DECLARE
+};
+
+struct TagInfo {
+    Tag tag;
+    const char* name;
+};
+
+constexpr TagInfo TAGS[] = {
+    {Tag::SEPARATOR, "Tag::SEPARATOR"},
+    {Tag::INTEGER, "Tag::INTEGER"},
+    {Tag::OPERATOR, "Tag::OPERATOR"},
+    {Tag::INDENT, "Tag::INDENT"},
+    {Tag::EOL, "Tag::EOL"},
+    {Tag::KEYWORD, "Tag::KEYWORD"},
+    {Tag::NAME, "Tag::NAME"},
+    {Tag::DEDENT, "Tag::DEDENT"},
+    {Tag::LEFT_BRACKET, "Tag::LEFT_BRACKET"},
+    {Tag::RIGHT_BRACKET, "Tag::RIGHT_BRACKET"},
+    {Tag::COMMA, "Tag::COMMA"},
+    {Tag::COLON, "Tag::COLON"},
+    {Tag::ASSIGN, "Tag::ASSIGN"},
+};
+
+
+constexpr size_t spellingLength(const char* spelling) {
+    size_t length = 0;
+    while (spelling[length] != '\0') ++length;
+    return length;
+}
+
+constexpr bool operatorsIndexed() {
+    for (size_t i = 0; i < sizeof(OPERATORS) / sizeof(*OPERATORS); ++i)
+        if (static_cast<size_t>(OPERATORS[i].code) != i) return false;
+    return true;
+}
+static_assert(operatorsIndexed(), "OPERATORS must be ordered by OpCode");
+
+constexpr unsigned short int opWeight(const OpCode code) {
+    return code == OpCode::UNKNOWN ? 0 :
+        OPERATORS[static_cast<size_t>(code)].weight;
+}
+
+constexpr Assoc opAssoc(const OpCode code) {
+    return code == OpCode::UNKNOWN ? Assoc::LEFT :
+        OPERATORS[static_cast<size_t>(code)].assoc;
+}
+
+inline OpCode toOpCode(StringRef op) {
+    for (const OperatorInfo& info: OPERATORS)
+        if (op == info.spelling) return info.code;
+    return OpCode::UNKNOWN;
+}
+
+
+/*
+ * Perfect hash of the keywords on first byte, last byte and length. The
+ * multiplier is searched at compile time until no two keywords share a slot.
+ */
+constexpr size_t KEYWORD_SLOTS = 16;
+constexpr size_t KEYWORD_COUNT = sizeof(KEYWORDS) / sizeof(*KEYWORDS);
+static_assert(static_cast<size_t>(Keyword::DECLARE) + 1 == KEYWORD_COUNT,
+    "Keyword must index KEYWORDS");
+
+constexpr size_t keywordSlot(
+    const unsigned int seed, const char* word, const size_t length
+) {
+    return (static_cast<unsigned char>(word[0]) * seed +
+        static_cast<unsigned char>(word[length - 1]) + length) &
+        (KEYWORD_SLOTS - 1);
+}
+
+constexpr unsigned int findKeywordSeed() {
+    for (unsigned int seed = 1; seed < 4096; ++seed) {
+        bool used[KEYWORD_SLOTS] = {};
+        bool collision = false;
+        for (size_t i = 0; i < KEYWORD_COUNT && !collision; ++i) {
+            const size_t slot =
+                keywordSlot(seed, KEYWORDS[i], spellingLength(KEYWORDS[i]));
+            collision = used[slot];
+            used[slot] = true;
+        }
+        if (!collision) return seed;
+    }
+    return 0;
+}
+
+constexpr unsigned int KEYWORD_SEED = findKeywordSeed();
+static_assert(KEYWORD_SEED != 0, "no collision free keyword hash");
+
+/* keyword index + 1 per slot, 0 for an empty slot */
+struct KeywordTable {
+    unsigned char slots[KEYWORD_SLOTS];
+};
+
+constexpr KeywordTable makeKeywordTable() {
+    KeywordTable table = {};
+    for (size_t i = 0; i < KEYWORD_COUNT; ++i) {
+        const size_t length = spellingLength(KEYWORDS[i]);
+        table.slots[keywordSlot(KEYWORD_SEED, KEYWORDS[i], length)] = i + 1;
+    }
+    return table;
+}
+
+constexpr KeywordTable KEYWORD_TABLE = makeKeywordTable();
+
+/* Tag::KEYWORD for a keyword, Tag::NAME for any other \w+ word */
+inline Tag classifyWord(StringRef word) {
+    if (word.empty()) return Tag::NAME;
+    const unsigned char index = KEYWORD_TABLE.slots[
+        keywordSlot(KEYWORD_SEED, word.data(), word.size())
+    ];
+    if (index == 0) return Tag::NAME;
+
+    const char* keyword = KEYWORDS[index - 1];
+    return std::strlen(keyword) == word.size() &&
+        std::memcmp(keyword, word.data(), word.size()) == 0 ?
+            Tag::KEYWORD : Tag::NAME;
+}
+
+
+/*
+ * A view into the source buffer, which has to outlive the lexem.
+ * Names are interned when the lexem is made. A DEDENT is empty and sits
+ * where the line closing its level starts, or at the end of the source.
+ */
 class Lexem {
-    bool empty = true;
+    const char* text = nullptr;
+    unsigned int start = 0;
+    unsigned int length = 0;
+    Symbol symbol;
     Tag tag = Tag::UNKNOWN;
-    string content;
-    unsigned int start;
-    unsigned int end;
-    unsigned int length;
 
 public:
     Lexem() = default;
-    explicit Lexem(const string& cont, unsigned int s, unsigned int e, Tag t);
+    explicit Lexem(const char* src, unsigned int s, unsigned int e, Tag t);
+    explicit Lexem(StringRef content, unsigned int s, Tag t);
+    /* a lexem seen before, its name already interned as sym */
+    explicit Lexem(const char* src, unsigned int s, unsigned int e, Tag t,
+        Symbol sym);
     ~Lexem() = default;
 
-    string getContent() const { return tag == Tag::EOL ? "\\n" : content; }
+    StringRef getContent() const {
+        return tag == Tag::EOL ? "\\n" : StringRef(text, length);
+    }
+    Symbol getSymbol() const { return symbol; }
+    unsigned int getStart() const { return start; }
     unsigned int getLength() const { return length; }
     Tag getTag() const { return tag; }
 
-    bool isEmpty() const { return empty && tag == Tag::UNKNOWN; }
+    bool isEmpty() const { return tag == Tag::UNKNOWN; }
 };
 ostream& operator << (ostream& os, const Lexem& lexem);
 
@@ -66,37 +265,71 @@ public:
 
     Tag getTag() const { return tag; }
     string getPattern() const { return string_pattern; }
-
-    Lexem match(const string& str, const unsigned int position=0) const;
 };
 
 
 
 
+/*
+ * Lines are indented by levels of INDENT_WIDTH spaces, spaces beyond the
+ * last full level are separators. A line deeper than the last non blank
+ * one gets an INDENT over the spaces of every level it opens, a shallower
+ * one a DEDENT per level it closes, and the levels still open are closed
+ * at the end of the source. Blank lines change no level.
+ */
+class TokenBuffer;
+
 class Lexer {
-    const vector<Token> tokens = {
-        Token("[ ]{4}", Tag::BLOCK),
-        Token("[ ]", Tag::SEPARATOR),
-        Token("\\d+", Tag::INTEGER),
-        Token("\\n", Tag::EOL),
-        Token("(define)|(while)|(if)|(else)|(return)|(declare)", Tag::KEYWORD),
-        Token("\\w+", Tag::NAME),
-        Token(",", Tag::COMMA),
-        Token(":", Tag::COLON),
-        Token("\\(", Tag::LEFT_BRACKET),
-        Token("\\)", Tag::RIGHT_BRACKET),
-        Token("(\\-)|(\\+)|(/)|(\\*)|(==)", Tag::OPERATOR),
-        Token("=", Tag::ASSIGN),
-    };
+    /* keywords are told apart from names by classifyWord() */
+    const vector<Token> tokens;
+
+    /* all tokens compiled together, rule index is the position in tokens */
+    const Automaton automaton;
 
     unsigned int line_count;
     unsigned int row_count;
 
 public:
+    static const size_t PARALLEL_CHUNK = 1 << 20;
+    static const unsigned int INDENT_WIDTH = 4;
+
     Lexer();
 
+    /* lexems refer to str, see CompilationUnit for an owning buffer */
     vector<Lexem> tokenize(const string& str) const throw(SyntaxError);
+    /* same lexems, chunks of at least minChunk bytes lexed on the pool */
+    vector<Lexem> tokenize(const string& str, llvm::ThreadPool& pool,
+        const size_t minChunk=PARALLEL_CHUNK) const throw(SyntaxError);
+    /* same lexems in the columns of tokens, which are viewing str after */
+    void tokenize(const string& str, TokenBuffer& tokens) const
+        throw(SyntaxError);
+    /*
+     * lexems of a line after lines left at `level`, which becomes the level
+     * this line leaves; no level is closed at its end
+     */
+    vector<Lexem> tokenize(const string& line, unsigned int& level) const
+        throw(SyntaxError);
+
+    /* one lexem at the start of [begin, end), any tag */
+    Automaton::Match match(const char* begin, const char* end) const {
+        return automaton.match(begin, end);
+    }
+    Tag getTag(const Automaton::Match& m, const char* begin) const {
+        const Tag tag = tokens[m.rule].getTag();
+        return tag == Tag::NAME ?
+            classifyWord(StringRef(begin, m.length)) : tag;
+    }
 
 private:
-    Lexem findLexem(const string&, const unsigned int position) const;
+    /* Output is anything taking push_back(Lexem) */
+    template<typename Output> void tokenize(const string&,
+        const unsigned int begin, const unsigned int end, Output&) const;
+    template<typename Output> void tokenize(const string&,
+        const unsigned int begin, const unsigned int end,
+        unsigned int& level, Output&) const;
+    Lexem findLexem(const string&,
+        const unsigned int position, const unsigned int end) const;
+    static unsigned int levelBefore(const string&, unsigned int line);
+    static vector<Token> makeTokens();
+    static vector<string> patterns(const vector<Token>&);
 };
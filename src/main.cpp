@@ -5,6 +5,7 @@ using std::cout;
 #ifdef RUN_TEST
     #include "../tests/test_parser/test_parser.h"
     #include "../tests/test_ast/test_ast.hpp"
+    #include "../tests/test_lexer/test_lexer.hpp"
 #else
     #include "lexer.hpp"
     #include "ast.hpp"
@@ -15,6 +16,7 @@ int main() {
 #ifdef RUN_TEST
     ASTTest::run();
     ParserTest::run();
+    LexerTest::run();
 #endif
     return 0;
 }
@@ -0,0 +1,126 @@
+#include <chrono>
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/IR/PassInstrumentation.h>
+#include <llvm/IR/PassManager.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Transforms/InstCombine/InstCombine.h>
+#include <llvm/Transforms/Scalar/GVN.h>
+#include <llvm/Transforms/Scalar/SimplifyCFG.h>
+#include <llvm/Transforms/Utils/Mem2Reg.h>
+
+#include "optimizer.hpp"
+
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/*
+ * Passes nest, a module pass runs function passes and those run analyses.
+ * Each one on the stack collects the time of the ones it ran, which is
+ * taken off its own when it ends.
+ */
+class PassTimer {
+    struct Running {
+        size_t index;
+        Clock::time_point start;
+        double children;
+    };
+
+    vector<PassTime>& times;
+    llvm::StringMap<size_t> indexes;
+    vector<Running> stack;
+
+public:
+    explicit PassTimer(vector<PassTime>& t) : times(t) {
+        for (size_t i = 0; i < times.size(); ++i)
+            indexes[times[i].name] = i;
+    }
+
+    void start(const llvm::StringRef name) {
+        auto known = indexes.insert({name, times.size()});
+        if (known.second) {
+            times.push_back(PassTime());
+            times.back().name = name.str();
+        }
+        stack.push_back({known.first->second, Clock::now(), 0});
+    }
+
+    void stop() {
+        const Running pass = stack.back();
+        stack.pop_back();
+        const std::chrono::duration<double> elapsed =
+            Clock::now() - pass.start;
+        times[pass.index].seconds += elapsed.count() - pass.children;
+        ++times[pass.index].runs;
+        if (!stack.empty()) stack.back().children += elapsed.count();
+    }
+
+    void registerOn(llvm::PassInstrumentationCallbacks& callbacks) {
+        callbacks.registerBeforeNonSkippedPassCallback(
+            [this](llvm::StringRef name, llvm::Any) { start(name); });
+        callbacks.registerAfterPassCallback(
+            [this](llvm::StringRef, llvm::Any, const llvm::PreservedAnalyses&) {
+                stop();
+            });
+        callbacks.registerAfterPassInvalidatedCallback(
+            [this](llvm::StringRef, const llvm::PreservedAnalyses&) {
+                stop();
+            });
+        callbacks.registerBeforeAnalysisCallback(
+            [this](llvm::StringRef name, llvm::Any) { start(name); });
+        callbacks.registerAfterAnalysisCallback(
+            [this](llvm::StringRef, llvm::Any) { stop(); });
+    }
+};
+
+}
+
+
+void Optimizer::run(llvm::Module& module, llvm::TargetMachine* target) {
+    if (target != nullptr) {
+        module.setDataLayout(target->createDataLayout());
+        module.setTargetTriple(target->getTargetTriple().str());
+    }
+    if (level == OptLevel::O0) return;
+
+    llvm::PassInstrumentationCallbacks callbacks;
+    PassTimer timer(times);
+    if (timing) timer.registerOn(callbacks);
+
+    llvm::LoopAnalysisManager loops;
+    llvm::FunctionAnalysisManager functions;
+    llvm::CGSCCAnalysisManager sccs;
+    llvm::ModuleAnalysisManager modules;
+    llvm::PassBuilder builder(target, llvm::PipelineTuningOptions(),
+        llvm::None, &callbacks);
+    builder.registerModuleAnalyses(modules);
+    builder.registerCGSCCAnalyses(sccs);
+    builder.registerFunctionAnalyses(functions);
+    builder.registerLoopAnalyses(loops);
+    builder.crossRegisterProxies(loops, functions, sccs, modules);
+
+    llvm::ModulePassManager passes;
+    if (level == OptLevel::O1) {
+        llvm::FunctionPassManager function;
+        function.addPass(llvm::PromotePass());
+        function.addPass(llvm::InstCombinePass());
+        function.addPass(llvm::GVNPass());
+        function.addPass(llvm::SimplifyCFGPass());
+        passes.addPass(
+            llvm::createModuleToFunctionPassAdaptor(std::move(function)));
+    } else {
+        passes = builder.buildPerModuleDefaultPipeline(
+            level == OptLevel::O2 ?
+                llvm::OptimizationLevel::O2 : llvm::OptimizationLevel::O3);
+    }
+    passes.run(module, modules);
+}
+
+double Optimizer::getSeconds() const {
+    double seconds = 0;
+    for (const PassTime& pass: times)
+        seconds += pass.seconds;
+    return seconds;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+
+#include <llvm/IR/Module.h>
+#include <llvm/Target/TargetMachine.h>
+
+
+enum class OptLevel : unsigned char {
+    /* the module as generated */
+    O0 = 0,
+    /* mem2reg, instcombine, GVN and simplifycfg on every function */
+    O1 = 1,
+    /* the standard pipelines of LLVM */
+    O2 = 2,
+    O3 = 3,
+};
+
+/* time a pass or an analysis took itself, the passes it ran not included */
+struct PassTime {
+    string name;
+    double seconds = 0;
+    size_t runs = 0;
+};
+
+
+/*
+ * Pass manager stage between codegen and the jit. Timing is on by default
+ * and adds up over runs; it costs two clock reads a pass.
+ */
+class Optimizer {
+    OptLevel level;
+    bool timing = true;
+    vector<PassTime> times;
+
+public:
+    explicit Optimizer(const OptLevel l=OptLevel::O2) : level(l) {}
+
+    void setTiming(const bool t) { timing = t; }
+    OptLevel getLevel() const { return level; }
+
+    /*
+     * The module has to verify, it stays verified. The passes tune for the
+     * target if there is one, which puts its data layout and triple on the
+     * module first; without, they see a generic one.
+     */
+    void run(llvm::Module&, llvm::TargetMachine* target=nullptr);
+
+    /* in the order passes first ran */
+    const vector<PassTime>& getTimes() const { return times; }
+    double getSeconds() const;
+    void clearTimes() { times.clear(); }
+};
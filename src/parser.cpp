@@ -1,256 +1,672 @@
+#include <algorithm>
 #include <cassert>
 
-#include "parser.hpp"
+#include <llvm/ADT/SmallVector.h>
 
+#include "parser.hpp"
 
-ParseResult IntegerParser::parse(CLIter begin, CLIter end) const {
-    ParseResult _default(begin);
-    if (begin == end) return _default;
 
-    string content = begin->getContent();
-    return begin->getTag() == Tag::INTEGER ?
-        ParseResult(begin + 1, new IntegerAST(std::atoi(content.c_str()))) :
-        _default;
+void Grammar::discard(BaseAST*& node, ParseState& s) {
+    if (s.arena == nullptr) delete node;
+    node = nullptr;
 }
 
 
+namespace {
 
+using namespace Grammar;
 
-ParseResult NameParser::parse(CLIter begin, CLIter end) const {
-    assert(block != nullptr);
-    if (begin == end) return ParseResult(begin);
 
-    return begin->getTag() == Tag::NAME ?
-        ParseResult(begin + 1, new NameAST(begin->getContent(), block)) :
-        ParseResult(begin);
+template<typename Node, typename... Args>
+BaseAST* make(ParseState& state, Args&&... args) {
+    if (state.arena == nullptr) return new Node(std::forward<Args>(args)...);
+    return new (*state.arena) Node(std::forward<Args>(args)...);
 }
 
 
+/*
+ * What the rules below make of what they matched. The grammar is written
+ * once against a Build, TreeBuild gives BaseAST objects and FlatBuild gives
+ * handles into a FlatAST.
+ */
+struct TreeBuild {
+    using Node = BaseAST*;
 
+    static Node integer(ParseState& s, const int value) {
+        return make<IntegerAST>(s, value);
+    }
+    static Node name(ParseState& s, const Symbol symbol) {
+        return make<NameAST>(s, symbol);
+    }
+    static Node binary(ParseState& s, OpCode code, Node lhs, Node rhs) {
+        return make<BinaryInstrAST>(s, code, lhs, rhs);
+    }
+    template<typename Arguments>
+    static Node call(ParseState& s, const Symbol symbol, Arguments arguments) {
+        return make<CallInstrAST>(s, symbol, std::move(arguments));
+    }
+    static Node assign(ParseState& s, const Symbol symbol, Node value) {
+        return make<AssignInstrAST>(s, symbol, value);
+    }
 
-OperandParser::OperandParser(llvm::BasicBlock *basicBlock) :
-    BaseParser(), block(basicBlock) {
-        alternatives = {
-            new CallInstrParser(block),
-            new NameParser(block),
-            new IntegerParser
-        };
-}
+    /* statements with bodies, the flat tree holds none of them */
+    static Node ret(ParseState& s, Node value) {
+        return make<ReturnAST>(s, value);
+    }
+    static Node branch(
+        ParseState& s, Node condition, Statements body, Statements otherwise
+    ) {
+        return make<IfAST>(
+            s, condition, std::move(body), std::move(otherwise));
+    }
+    static Node loop(ParseState& s, Node condition, Statements body) {
+        return make<WhileAST>(s, condition, std::move(body));
+    }
+    template<typename Names> static Node function(
+        ParseState& s, const Symbol symbol, const Names& names, Statements body
+    ) {
+        PrototypeAST::Arguments arguments{ArenaAllocator<Symbol>(s.arena)};
+        for (const Lexem* name: names)
+            arguments.push_back(name->getSymbol());
+        auto* prototype = static_cast<PrototypeAST*>(
+            make<PrototypeAST>(s, symbol, std::move(arguments)));
+        return make<FunctionAST>(s, prototype, std::move(body));
+    }
+};
 
-ParseResult OperandParser::parse(CLIter begin, CLIter end) const {
-    assert(block != nullptr);
-    if (begin == end) return ParseResult(begin);
+struct FlatBuild {
+    using Node = NodeId;
 
-    for (BaseParser* alt: alternatives) {
-        auto tempResult = alt->parse(begin, end);
-        if (!tempResult.isEmpty()) {
-            return tempResult;
+    static Node integer(ParseState& s, const int value) {
+        return s.tree->integer(value);
+    }
+    static Node name(ParseState& s, const Symbol symbol) {
+        return s.tree->name(symbol);
+    }
+    static Node binary(ParseState& s, OpCode code, Node lhs, Node rhs) {
+        return s.tree->binary(code, lhs, rhs);
+    }
+    template<typename Arguments>
+    static Node call(ParseState& s, const Symbol symbol, Arguments arguments) {
+        return s.tree->call(symbol,
+            llvm::ArrayRef<NodeId>(arguments.data(), arguments.size()));
+    }
+    static Node assign(ParseState& s, const Symbol symbol, Node value) {
+        return s.tree->assign(symbol, value);
+    }
+};
+
+
+template<typename Build> struct Integer : Alternative<Tagged<Tag::INTEGER>> {
+    using Value = typename Build::Node;
+
+    Result<Value> parse(CLIter begin, CLIter end, ParseState& state) const {
+        int value = 0;
+        if (begin == end || begin->getTag() != Tag::INTEGER ||
+            begin->getContent().getAsInteger(10, value))
+                return fail<Value>(begin);
+        return accept(begin + 1, Build::integer(state, value));
+    }
+};
+
+template<typename Build> struct MakeName {
+    typename Build::Node operator()(const Lexem* name, ParseState& s) const {
+        return Build::name(s, name->getSymbol());
+    }
+};
+
+template<typename Build> using Name = Map<Tagged<Tag::NAME>, MakeName<Build>>;
+
+
+/*
+ * BINARY with the operands nested into it, parsed on explicit stacks: a
+ * frame per open group or call, the operators and operands of all frames
+ * in shared stacks. Nesting costs heap memory, not native stack, and is
+ * bounded by ParseState::depthLimit. Operators are grouped by the weights
+ * and associativity of OPERATORS as precedence climbing would.
+ *
+ *     OPERAND = '(' BINARY ')' | NAME '(' (BINARY (',' BINARY)*)? ')'
+ *             | NAME | INTEGER
+ */
+template<typename Build> struct Expression {
+    using Value = typename Build::Node;
+
+    static constexpr TagSet first() {
+        return tagSet(Tag::LEFT_BRACKET) | tagSet(Tag::NAME) |
+            tagSet(Tag::INTEGER);
+    }
+    static constexpr TagSet second() { return ANY_TAG; }
+    static constexpr bool nullable() { return false; }
+    static constexpr bool single() { return false; }
+
+    Result<Value> parse(CLIter, CLIter, ParseState&) const;
+
+private:
+    enum class Kind : uint8_t { TOP, GROUP, CALL };
+
+    struct Frame {
+        Kind kind;
+        Symbol name;
+        /* where the stacks held what was there before the frame */
+        uint32_t operators;
+        uint32_t operands;
+        uint32_t arguments;
+    };
+
+    struct Stacks {
+        llvm::SmallVector<Frame, 8> frames;
+        llvm::SmallVector<OpCode, 16> operators;
+        llvm::SmallVector<Value, 16> operands;
+        llvm::SmallVector<Value, 8> arguments;
+
+        void open(const Kind kind, const Symbol name=Symbol()) {
+            frames.push_back({kind, name, uint32_t(operators.size()),
+                uint32_t(operands.size()), uint32_t(arguments.size())});
+        }
+
+        /* operators of the innermost frame binding at least as tight */
+        void reduce(ParseState& s, const unsigned weight, const bool left) {
+            while (operators.size() > frames.back().operators) {
+                const unsigned top = opWeight(operators.back());
+                if (top < weight || (top == weight && !left)) break;
+                const Value rhs = operands.pop_back_val();
+                const Value lhs = operands.pop_back_val();
+                operands.push_back(
+                    Build::binary(s, operators.pop_back_val(), lhs, rhs));
+            }
+        }
+
+        Value call(ParseState& s) {
+            const Frame& frame = frames.back();
+            vector<Value, ArenaAllocator<Value>> values{
+                ArenaAllocator<Value>(s.arena)};
+            values.assign(
+                arguments.begin() + frame.arguments, arguments.end());
+            arguments.resize(frame.arguments);
+            const Value node = Build::call(s, frame.name, std::move(values));
+            frames.pop_back();
+            return node;
+        }
+
+        /* what a failed parse built so far, arguments of open calls too */
+        void drop(ParseState& s) {
+            for (Value& operand: operands) discard(operand, s);
+            for (Value& argument: arguments) discard(argument, s);
+            operands.clear();
+            arguments.clear();
+        }
+    };
+
+    /* the frame just opened is beyond the limit */
+    static bool tooDeep(const Stacks& stacks, ParseState& s, CLIter at) {
+        /* the TOP frame is no nesting */
+        if (s.depthLimit == 0 || stacks.frames.size() <= s.depthLimit + 1)
+            return false;
+        s.tooDeep = true;
+        s.tooDeepAt = at;
+        return true;
+    }
+};
+
+template<typename Build> Result<typename Build::Node>
+Expression<Build>::parse(CLIter begin, CLIter end, ParseState& s) const {
+    Stacks stacks;
+    stacks.open(Kind::TOP);
+    CLIter cursor = begin;
+    const auto failed = [&] {
+        stacks.drop(s);
+        return fail<Value>(begin);
+    };
+
+    for (;;) {
+        /* an operand, or what opens a group or a call */
+        const Tag tag = cursor != end ? cursor->getTag() : Tag::UNKNOWN;
+        int integer = 0;
+        if (tag == Tag::LEFT_BRACKET) {
+            stacks.open(Kind::GROUP);
+            if (tooDeep(stacks, s, cursor)) return failed();
+            ++cursor;
+            continue;
+        } else if (tag == Tag::NAME && cursor + 1 != end &&
+            (cursor + 1)->getTag() == Tag::LEFT_BRACKET) {
+                stacks.open(Kind::CALL, cursor->getSymbol());
+                if (tooDeep(stacks, s, cursor)) return failed();
+                cursor += 2;
+                if (cursor == end || cursor->getTag() != Tag::RIGHT_BRACKET)
+                    continue;
+                ++cursor;
+                stacks.operands.push_back(stacks.call(s));
+        } else if (tag == Tag::NAME) {
+            stacks.operands.push_back(Build::name(s, cursor->getSymbol()));
+            ++cursor;
+        } else if (tag == Tag::INTEGER &&
+            !cursor->getContent().getAsInteger(10, integer)) {
+                stacks.operands.push_back(Build::integer(s, integer));
+                ++cursor;
+        } else {
+            s.expect(cursor, first());
+            return failed();
+        }
+
+        /* after an operand: an operator, or the end of the innermost frame */
+        for (;;) {
+            if (cursor != end && cursor->getTag() == Tag::OPERATOR) {
+                const OpCode code = toOpCode(cursor->getContent());
+                stacks.reduce(s, opWeight(code), opAssoc(code) == Assoc::LEFT);
+                stacks.operators.push_back(code);
+                ++cursor;
+                break;
+            }
+            stacks.reduce(s, 0, true);
+
+            const Frame& frame = stacks.frames.back();
+            const Tag next = cursor != end ? cursor->getTag() : Tag::UNKNOWN;
+            if (frame.kind == Kind::TOP)
+                return accept(cursor, stacks.operands.pop_back_val());
+
+            if (frame.kind == Kind::GROUP && next == Tag::RIGHT_BRACKET) {
+                stacks.frames.pop_back();
+                ++cursor;
+                continue;
+            }
+            if (frame.kind == Kind::CALL &&
+                (next == Tag::COMMA || next == Tag::RIGHT_BRACKET)) {
+                    stacks.arguments.push_back(stacks.operands.pop_back_val());
+                    ++cursor;
+                    if (next == Tag::COMMA) break;
+                    stacks.operands.push_back(stacks.call(s));
+                    continue;
+            }
+
+            s.expect(cursor, tagSet(Tag::OPERATOR) |
+                tagSet(Tag::RIGHT_BRACKET) |
+                (frame.kind == Kind::CALL ? tagSet(Tag::COMMA) : NO_TAGS));
+            return failed();
         }
     }
-    throw ParseError();
 }
 
 
+template<size_t I> struct Pick {
+    template<typename Tuple> typename std::tuple_element<I, Tuple>::type
+    operator()(Tuple value, ParseState&) const {
+        return std::get<I>(std::move(value));
+    }
+};
 
+template<typename Build> using Binary = Expression<Build>;
+template<typename Build>
+using GroupTail = Map<Seq<Binary<Build>, Tagged<Tag::RIGHT_BRACKET>>, Pick<0>>;
+template<typename Build>
+using Group = Map<Seq<Tagged<Tag::LEFT_BRACKET>, GroupTail<Build>>, Pick<1>>;
 
-ParseResult BinaryParser::parse(CLIter begin, CLIter end) const {
-    if (begin == end) return ParseResult(begin);
 
-    ParseResult first = takeOperand(begin, end);
-    CLIter current = first.cursor;
-    BaseAST* root = first.ast;
-    while (!finish(current, end)) {
-        string op = takeOperator(current, end);
-        current++;
-        ParseResult second = takeOperand(current, end);
-        current = second.cursor;
-        root = buildTree(op, first.ast, second.ast);
-        first.ast = root;
+template<typename Build> struct MakeCall {
+    template<typename Call>
+    typename Build::Node operator()(Call call, ParseState& s) const {
+        return Build::call(s,
+            std::get<0>(call)->getSymbol(), std::move(std::get<2>(call)));
     }
-    return ParseResult(current + (hasParen ? 1 : 0), root);
-}
+};
 
-bool BinaryParser::finish(const CLIter cursor, const CLIter end) const {
-    return (cursor == end) || (cursor->getTag() == Tag::RIGHT_BRACKET ||
-        cursor->getTag() == Tag::EOL || cursor->getTag() == Tag::COMMA);
-}
+template<typename Build> using Argument = Binary<Build>;
+template<typename Build> using Call = Map<Seq<
+    Tagged<Tag::NAME>, Tagged<Tag::LEFT_BRACKET>,
+    Rep<Argument<Build>, Tagged<Tag::COMMA>>,
+    Tagged<Tag::RIGHT_BRACKET>
+>, MakeCall<Build>>;
+
+template<typename Build> using Operand =
+    Alt<Group<Build>, Call<Build>, Name<Build>, Integer<Build>>;
 
-ParseResult BinaryParser::takeOperand(CLIter begin, CLIter end) const {
-    switch (begin->getTag()) {
-        case Tag::LEFT_BRACKET:
-            return BinaryParser(block, true).parse(begin + 1, end);
-        case Tag::NAME:
-        case Tag::INTEGER:
-            return OperandParser(block).parse(begin, end);
-        default:
-            throw ParseError();
+
+template<typename Build> struct MakeAssign {
+    template<typename Assign>
+    typename Build::Node operator()(Assign assign, ParseState& s) const {
+        return Build::assign(s,
+            std::get<0>(assign)->getSymbol(), std::get<2>(assign));
     }
-}
+};
+
+template<typename Build> using AssignValue = Binary<Build>;
+template<typename Build> using Assign = Map<Seq<
+    Tagged<Tag::NAME>, Tagged<Tag::ASSIGN>, AssignValue<Build>
+>, MakeAssign<Build>>;
+
+template<typename Build> using Simple = Map<Seq<
+    Alt<Assign<Build>, Call<Build>>, Opt<Tagged<Tag::EOL>>
+>, Pick<0>>;
+
+
+/*
+ * Statements with indented bodies, made by TreeBuild only. A body holds
+ * statements, so Statement is a named rule.
+ *
+ *     STATEMENT = SIMPLE | RETURN | IF | WHILE | DEFINE
+ *     RETURN    = 'return' BINARY EOL?
+ *     IF        = 'if' BINARY ':' BODY ('else' ':' BODY)?
+ *     WHILE     = 'while' BINARY ':' BODY
+ *     DEFINE    = 'define' NAME '(' (NAME (',' NAME)*)? ')' ':' BODY
+ *     BODY      = EOL INDENT (STATEMENT | EOL)+ DEDENT
+ */
+template<typename Build> struct Statement {
+    using Value = typename Build::Node;
+
+    static constexpr TagSet first() {
+        return tagSet(Tag::NAME) | tagSet(Tag::KEYWORD);
+    }
+    static constexpr TagSet second() { return ANY_TAG; }
+    static constexpr bool nullable() { return false; }
+    static constexpr bool single() { return false; }
 
-string BinaryParser::takeOperator(const CLIter begin, const CLIter end) const {
-    assert(begin < end);
+    Result<Value> parse(CLIter, CLIter, ParseState&) const;
+};
 
-    if (begin->getTag() == Tag::OPERATOR)
-        return begin->getContent();
+/* blank lines of a body, dropped by MakeBody */
+template<typename Build> struct Blank {
+    typename Build::Node operator()(const Lexem*, ParseState&) const {
+        return typename Build::Node();
+    }
+};
+
+template<typename Build> using Line = Alt<
+    Statement<Build>, Map<Tagged<Tag::EOL>, Blank<Build>>
+>;
+
+template<typename Build> struct MakeBody {
+    template<typename Body>
+    typename Rep<Line<Build>>::Value operator()(Body body, ParseState&) const {
+        auto lines = std::get<2>(std::move(body));
+        lines.erase(std::remove(lines.begin(), lines.end(),
+            typename Build::Node()), lines.end());
+        return lines;
+    }
+};
 
-    throw ParseError();
-}
+template<typename Build> using Body = Map<Seq<
+    Tagged<Tag::EOL>, Tagged<Tag::INDENT>, Rep<Line<Build>>,
+    Tagged<Tag::DEDENT>
+>, MakeBody<Build>>;
 
-BinaryInstrAST* BinaryParser::buildTree(
-    const string &op, BaseAST *lhs, BaseAST *rhs
-) const {
-    auto* leftSubTree = dynamic_cast<BinaryInstrAST*>(lhs);
-    if (leftSubTree == nullptr)
-        return new BinaryInstrAST(op, lhs, rhs, block, hasParen);
-
-    auto* rightSubTree = dynamic_cast<BinaryInstrAST*>(rhs);
-    if (rightSubTree == nullptr)
-        return leftSubTree->weight() >= OP_WEIGHT.at(toOpCode(op)) ?
-            new BinaryInstrAST(op, leftSubTree, rhs, block, hasParen) :
-            new BinaryInstrAST(leftSubTree->getOperator(),
-                leftSubTree->getLeft(), new BinaryInstrAST(op,
-                    leftSubTree->getRight(), rhs, block
-                ), block, hasParen
-            );
-
-    return new BinaryInstrAST(op, leftSubTree, rightSubTree, block, hasParen);
-}
 
+template<typename Build> struct MakeReturn {
+    template<typename Return>
+    typename Build::Node operator()(Return ret, ParseState& s) const {
+        return Build::ret(s, std::get<1>(ret));
+    }
+};
+
+template<typename Build> using Return = Map<Seq<
+    Reserved<Keyword::RETURN>, Binary<Build>, Opt<Tagged<Tag::EOL>>
+>, MakeReturn<Build>>;
+
+template<typename Build> struct MakeIf {
+    template<typename If>
+    typename Build::Node operator()(If branch, ParseState& s) const {
+        return Build::branch(s, std::get<1>(branch),
+            std::get<3>(std::move(branch)),
+            std::get<2>(std::get<4>(std::move(branch))));
+    }
+};
+
+template<typename Build> using If = Map<Seq<
+    Reserved<Keyword::IF>, Binary<Build>, Tagged<Tag::COLON>, Body<Build>,
+    Opt<Seq<Reserved<Keyword::ELSE>, Tagged<Tag::COLON>, Body<Build>>>
+>, MakeIf<Build>>;
 
+template<typename Build> struct MakeWhile {
+    template<typename While>
+    typename Build::Node operator()(While loop, ParseState& s) const {
+        return Build::loop(s, std::get<1>(loop), std::get<3>(std::move(loop)));
+    }
+};
 
+template<typename Build> using While = Map<Seq<
+    Reserved<Keyword::WHILE>, Binary<Build>, Tagged<Tag::COLON>, Body<Build>
+>, MakeWhile<Build>>;
 
-ArgumentParser::ArgumentParser(llvm::BasicBlock *b) : BaseParser(), block(b) {
-    parsers = {
-        new CallInstrParser(block),
-        new BinaryParser(block),
-        new NameParser(block),
-        new IntegerParser
-    };
+template<typename Build> struct MakeFunction {
+    template<typename Define>
+    typename Build::Node operator()(Define define, ParseState& s) const {
+        return Build::function(s, std::get<1>(define)->getSymbol(),
+            std::get<3>(define), std::get<6>(std::move(define)));
+    }
+};
+
+template<typename Build> using Define = Map<Seq<
+    Reserved<Keyword::DEFINE>, Tagged<Tag::NAME>, Tagged<Tag::LEFT_BRACKET>,
+    Rep<Tagged<Tag::NAME>, Tagged<Tag::COMMA>>, Tagged<Tag::RIGHT_BRACKET>,
+    Tagged<Tag::COLON>, Body<Build>
+>, MakeFunction<Build>>;
+
+template<typename Build> Result<typename Build::Node>
+Statement<Build>::parse(CLIter begin, CLIter end, ParseState& s) const {
+    return Alt<Simple<Build>, Return<Build>, If<Build>, While<Build>,
+        Define<Build>>().parse(begin, end, s);
 }
 
-ArgumentParser::~ArgumentParser() {
-    for (BaseParser* parser: parsers)
-        delete parser;
+
+template<template<typename> class Rule>
+ParseResult run(const CLIter begin, const CLIter end, ParseState& state) {
+    const auto result = Rule<TreeBuild>().parse(begin, end, state);
+    return result.success ?
+        ParseResult(result.cursor, result.value) : ParseResult(begin);
 }
 
-ParseResult ArgumentParser::parse(CLIter begin, CLIter end) const {
-    for (BaseParser* parser: parsers) {
-        ParseResult tempResult = parser->parse(begin, end);
-        if (!tempResult.isEmpty())
-            return tempResult;
+/* the furthest failure of a parse that started at begin */
+ParseResult failure(const ParseState& state, CLIter begin, CLIter end) {
+    ParseResult result(begin);
+    if (state.tooDeep) {
+        result.failure = state.tooDeepAt;
+        result.error = ParseErrorCode::TOO_DEEP;
+        return result;
     }
-    throw ParseError();
+    result.failure = state.expected != NO_TAGS ? state.furthest : begin;
+    result.expected = state.expected;
+    result.error = result.failure == end ?
+        ParseErrorCode::UNEXPECTED_END : ParseErrorCode::UNEXPECTED_LEXEM;
+    return result;
 }
 
+/* a parse followed by a lexem that may not end it, the tree is dropped */
+ParseResult trailing(
+    ParseState& state, ParseResult parsed, CLIter begin, const TagSet endings
+) {
+    discard(parsed.ast, state);
+    ParseResult result(begin);
+    result.failure = parsed.cursor;
+    result.expected = endings;
+    if (state.expected != NO_TAGS && state.furthest == parsed.cursor)
+        result.expected |= state.expected;
+    result.error = ParseErrorCode::TRAILING_LEXEMS;
+    return result;
+}
 
+/* a statement ends the source, its line or a body */
+bool ended(const CLIter cursor, const CLIter end) {
+    return cursor == end || (cursor - 1)->getTag() == Tag::EOL ||
+        (cursor - 1)->getTag() == Tag::DEDENT;
+}
 
+/* where the lexem at starts in the source, or where the lexems end */
+size_t offset(const CLIter begin, const CLIter at, const CLIter end) {
+    if (at != end) return at->getStart();
+    if (at == begin) return 0;
+    return (at - 1)->getStart() + (at - 1)->getLength();
+}
 
-ParseResult CallInstrParser::parse(CLIter begin, CLIter end) const {
-    assert(begin < end);
+}
 
-    const string name = takeName(begin, end);
-    CLIter current = begin + 1;
-    if (name == "" || current->getTag() != Tag::LEFT_BRACKET)
-        return ParseResult(begin);
-    vector<BaseAST*> args;
-    current += 1;
-    while (!finish(current, end)) {
-        ParseResult argument = takeArgument(current, end);
-        args.push_back(argument.ast);
-        current = skipComma(argument.cursor);
-    }
 
-    /*Skip close bracket and make AST*/
-    return ParseResult(current + 1, new CallInstrAST(name, args, block));
+ParseResult BaseParser::reject(const ParseResult& failed, CLIter end) const {
+    if (throwing)
+        throw ParseError(failed.error,
+            offset(failed.cursor, failed.failure, end));
+    return failed;
 }
 
-bool CallInstrParser::finish(CLIter current, CLIter end) const {
-    return current == end || current->getTag() == Tag::RIGHT_BRACKET;
+
+
+
+ParseResult IntegerParser::parse(CLIter begin, CLIter end) const {
+    ParseState state = getState();
+    return run<Integer>(begin, end, state);
 }
 
-CLIter CallInstrParser::skipComma(CLIter current) const {
-    return current + (current->getTag() == Tag::COMMA ? 1 : 0);
+
+
+
+ParseResult NameParser::parse(CLIter begin, CLIter end) const {
+    ParseState state = getState();
+    return run<Name>(begin, end, state);
 }
 
-string CallInstrParser::takeName(CLIter begin, CLIter end) const {
-    assert(begin < end);
 
-    if (begin->getTag() == Tag::NAME)
-        return begin->getContent();
-    return string();
+
+
+ParseResult OperandParser::parse(CLIter begin, CLIter end) const {
+    if (begin == end) return ParseResult(begin);
+
+    ParseState state = getState();
+    const ParseResult result = run<Operand>(begin, end, state);
+    if (result.isEmpty()) return reject(failure(state, begin, end), end);
+    return result;
 }
 
-ParseResult CallInstrParser::takeArgument(CLIter begin, CLIter end) const {
-    return ArgumentParser(block).parse(begin, end);
+
+
+
+ParseResult BinaryParser::parse(CLIter begin, CLIter end) const {
+    if (begin == end) return ParseResult(begin);
+
+    ParseState state = getState();
+    const ParseResult result = hasParen ?
+        run<GroupTail>(begin, end, state) : run<Binary>(begin, end, state);
+    if (result.isEmpty()) return reject(failure(state, begin, end), end);
+    if (!hasParen && !finish(result.cursor, end))
+        return reject(trailing(state, result, begin, tagSet(Tag::EOL) |
+            tagSet(Tag::COMMA) | tagSet(Tag::RIGHT_BRACKET)), end);
+    return result;
+}
+
+bool BinaryParser::finish(const CLIter cursor, const CLIter end) const {
+    return (cursor == end) || (cursor->getTag() == Tag::RIGHT_BRACKET ||
+        cursor->getTag() == Tag::EOL || cursor->getTag() == Tag::COMMA);
 }
 
 
 
 
-AssignValueParser::AssignValueParser(llvm::BasicBlock *basicBlock) :
-    BaseParser(), block(basicBlock) {
-        parsers = {
-            new CallInstrParser(block),
-            new BinaryParser(block),
-            new IntegerParser
-        };
+ParseResult ArgumentParser::parse(CLIter begin, CLIter end) const {
+    ParseState state = getState();
+    const ParseResult result = run<Argument>(begin, end, state);
+    if (result.isEmpty()) return reject(failure(state, begin, end), end);
+    return result;
 }
 
-AssignValueParser::~AssignValueParser() {
-    for (BaseParser* parser: parsers)
-        delete parser;
+
+
+
+ParseResult CallInstrParser::parse(CLIter begin, CLIter end) const {
+    assert(begin < end);
+
+    ParseState state = getState();
+    const ParseResult result = run<Call>(begin, end, state);
+    /* a name and an open bracket commit to a call */
+    ParseState head = getState();
+    if (result.isEmpty() && Seq<Tagged<Tag::NAME>, Tagged<Tag::LEFT_BRACKET>>()
+        .parse(begin, end, head).success)
+            return reject(failure(state, begin, end), end);
+    return result;
 }
 
+
+
+
 ParseResult AssignValueParser::parse(CLIter begin, CLIter end) const {
     assert(begin < end);
 
-    for (BaseParser* parser: parsers) {
-        ParseResult tempResult = parser->parse(begin, end);
-        if (!tempResult.isEmpty()) {
-            return tempResult;
-        }
-    }
-    throw ParseError();
+    ParseState state = getState();
+    const ParseResult result = run<AssignValue>(begin, end, state);
+    if (result.isEmpty()) return reject(failure(state, begin, end), end);
+    return result;
 }
 
 
 
 
-AssignInstrParser::AssignInstrParser(llvm::BasicBlock *b) :
-    BaseParser(), block(b) {}
-AssignInstrParser::~AssignInstrParser() {}
+ParseResult AssignInstrParser::parse(CLIter begin, CLIter end) const {
+    if (begin == end) return ParseResult(begin);
+
+    ParseState state = getState();
+    const ParseResult result = run<Assign>(begin, end, state);
+    if (result.isEmpty()) return reject(failure(state, begin, end), end);
+    /* the last statement of a source may end without a newline */
+    if (result.cursor == end || result.cursor->getTag() == Tag::EOL)
+        return result;
+    return reject(trailing(state, result, begin, tagSet(Tag::EOL)), end);
+}
+
 
 
-ParseResult AssignInstrParser::parse(CLIter begin, CLIter end) const {
+
+template<template<typename> class Rule>
+ParseResult BaseParser::statement(CLIter begin, CLIter end) const {
     if (begin == end) return ParseResult(begin);
 
-    const string name = takeName(begin, end);
-    CLIter current = skipAssignOperator(begin + 1);
-    ParseResult value = takeValue(current, end);
-    current = value.cursor;
-    if (current->getTag() == Tag::EOL)
-        return ParseResult(current, new AssignInstrAST(name, value.ast, block));
-    throw ParseError();
+    ParseState state = getState();
+    const ParseResult result = run<Rule>(begin, end, state);
+    if (result.isEmpty()) return reject(failure(state, begin, end), end);
+    if (!ended(result.cursor, end))
+        return reject(trailing(state, result, begin, tagSet(Tag::EOL)), end);
+    return result;
 }
 
-string AssignInstrParser::takeName(const CLIter begin, const CLIter end) const {
-    assert(begin < end);
-    if (begin->getTag() == Tag::NAME)
-        return begin->getContent();
-    throw ParseError();
+
+
+
+ParseResult ReturnParser::parse(CLIter begin, CLIter end) const {
+    return statement<Return>(begin, end);
 }
 
-CLIter AssignInstrParser::skipAssignOperator(const CLIter current) const {
-    if (current->getTag() == Tag::ASSIGN)
-        return current + 1;
-    throw ParseError();
+ParseResult IfParser::parse(CLIter begin, CLIter end) const {
+    return statement<If>(begin, end);
 }
 
-using Res = ParseResult;
-Res AssignInstrParser::takeValue(const CLIter begin, const CLIter end) const {
-    assert(begin < end);
-    return AssignValueParser(block).parse(begin, end);
+ParseResult WhileParser::parse(CLIter begin, CLIter end) const {
+    return statement<While>(begin, end);
+}
+
+ParseResult FunctionParser::parse(CLIter begin, CLIter end) const {
+    return statement<Define>(begin, end);
 }
 
 
 
+
+ParseResult StatementParser::parse(CLIter begin, CLIter end) const {
+    if (begin != end && begin->getTag() == Tag::EOL)
+        return ParseResult(begin + 1);
+    return statement<Statement>(begin, end);
+}
+
+
+
+
+FlatParseResult FlatStatementParser::parse(CLIter begin, CLIter end) const {
+    if (begin == end) return FlatParseResult(begin);
+    if (begin->getTag() == Tag::EOL) return FlatParseResult(begin + 1);
+
+    ParseState state;
+    state.tree = &tree;
+    const auto result = Simple<FlatBuild>().parse(begin, end, state);
+    if (!result.success) {
+        const ParseResult failed = failure(state, begin, end);
+        throw ParseError(failed.error, offset(begin, failed.failure, end));
+    }
+    if (!ended(result.cursor, end))
+        throw ParseError(ParseErrorCode::TRAILING_LEXEMS,
+            offset(begin, result.cursor, end));
+    tree.addRoot(result.value);
+    return FlatParseResult(result.cursor, result.value);
+}
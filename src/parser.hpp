@@ -2,23 +2,78 @@
 
 #include "ast.hpp"
 #include "lexer.hpp"
+#include "combinators.hpp"
+#include "flat.hpp"
 
 
-using CLIter = typename vector<Lexem>::const_iterator;
 struct ParseResult {
     CLIter cursor;
     BaseAST* ast = nullptr;
 
+    /* why a parse failed, the lexem it failed at and the tags wanted there */
+    ParseErrorCode error = ParseErrorCode::NONE;
+    CLIter failure;
+    TagSet expected = NO_TAGS;
+
     ParseResult() = default;
     ParseResult(CLIter result, BaseAST* tree=nullptr) :
         cursor(result), ast(tree) {}
 
     bool isEmpty() const { return ast == nullptr; }
+    bool isError() const { return error != ParseErrorCode::NONE; }
+};
+
+struct FlatParseResult {
+    CLIter cursor;
+    NodeId node = FlatAST::NO_NODE;
+
+    FlatParseResult() = default;
+    FlatParseResult(CLIter result, NodeId tree=FlatAST::NO_NODE) :
+        cursor(result), node(tree) {}
+
+    bool isEmpty() const { return node == FlatAST::NO_NODE; }
 };
 
+/*
+ * The parsers below are entry points into the grammar of parser.cpp, which is
+ * composed from the combinators of combinators.hpp. Only the call into a
+ * parser is virtual, the rules underneath are plain inlined code.
+ */
 class BaseParser {
+protected:
+    /* where nodes go, the heap without one */
+    Arena* arena = nullptr;
+    Grammar::Counters* counters = nullptr;
+    bool predictive = true;
+    bool throwing = true;
+    size_t depthLimit = 0;
+
+    Grammar::ParseState getState() const {
+        Grammar::ParseState state;
+        state.arena = arena;
+        state.counters = counters;
+        state.predictive = predictive;
+        state.depthLimit = depthLimit;
+        return state;
+    }
+
+    /* a failed parse thrown as ParseError, or returned when not throwing */
+    ParseResult reject(const ParseResult& failed, const CLIter end) const;
+    /* Rule of parser.cpp, which has to end where a statement may */
+    template<template<typename> class Rule>
+    ParseResult statement(CLIter begin, CLIter end) const;
+
 public:
-    BaseParser() = default;
+    BaseParser(Arena* a=nullptr) : arena(a) {}
+
+    /* alternatives attempted while parsing */
+    void setCounters(Grammar::Counters* c) { counters = c; }
+    /* false tries every alternative in turn, as before FIRST sets */
+    void setPredictive(const bool p) { predictive = p; }
+    /* false returns errors in the ParseResult instead of throwing them */
+    void setThrowing(const bool t) { throwing = t; }
+    /* groups and calls an expression may nest, any number with 0 */
+    void setDepthLimit(const size_t limit) { depthLimit = limit; }
     virtual ParseResult parse(CLIter, CLIter) const = 0;
     virtual ~BaseParser() = default;
 };
@@ -26,7 +81,7 @@ public:
 
 class IntegerParser final : public BaseParser {
 public:
-    IntegerParser() : BaseParser() {}
+    IntegerParser(Arena* a=nullptr) : BaseParser(a) {}
     virtual ~IntegerParser() {}
 
     virtual ParseResult parse(CLIter, CLIter) const override final;
@@ -34,10 +89,8 @@ public:
 
 
 class NameParser final : public BaseParser {
-    llvm::BasicBlock* block = nullptr;
-
 public:
-    NameParser(llvm::BasicBlock* b) : BaseParser(), block(b) {}
+    NameParser(Arena* a=nullptr) : BaseParser(a) {}
     ~NameParser() override {}
 
     ParseResult parse(CLIter, CLIter) const override final;
@@ -45,17 +98,11 @@ public:
 
 
 class OperandParser final : public BaseParser {
-    /* OPERAND = NUMBER | VARIABLE | CALL_INSTR */
-
-    llvm::BasicBlock* block = nullptr;
-    vector<BaseParser*> alternatives;
+    /* OPERAND = '(' + BINARY + ')' | CALL_INSTR | VARIABLE | NUMBER */
 
 public:
-    OperandParser(llvm::BasicBlock* b);
-    virtual ~OperandParser() override {
-        for (BaseParser* alt: alternatives)
-            delete alt;
-    }
+    OperandParser(Arena* a=nullptr) : BaseParser(a) {}
+    virtual ~OperandParser() override {}
 
     virtual ParseResult parse(CLIter, CLIter) const override final;
 };
@@ -63,37 +110,30 @@ public:
 
 class BinaryParser final : public BaseParser {
     /*
-     * BINARY = OPERAND + OPERATOR + BINARY |
-     *          '(' + OPERAND + OPERATOR + BINARY + ')' |
-     *          OPERAND
+     * BINARY = OPERAND + (OPERATOR + OPERAND)*
+     * grouped by the weight and associativity of OPERATORS; with paren
+     * the input starts after '(' and the matching ')' is consumed
     */
-    llvm::BasicBlock* block = nullptr;
     bool hasParen;
 
 public:
-    BinaryParser(llvm::BasicBlock* b, const bool paren=false) :
-        BaseParser(), block(b), hasParen(paren) {}
+    BinaryParser(const bool paren=false, Arena* a=nullptr) :
+        BaseParser(a), hasParen(paren) {}
     virtual ~BinaryParser() override {}
 
     virtual ParseResult parse(CLIter, CLIter) const override final;
 
 private:
-    ParseResult takeOperand(CLIter, CLIter) const;
-    string takeOperator(const CLIter, const CLIter) const;
-    BinaryInstrAST* buildTree(const string&, BaseAST*, BaseAST*) const;
     bool finish(const CLIter, const CLIter) const;
 };
 
 
 class ArgumentParser final : public BaseParser {
-    /* ARG = NAME | INTEGER | CALL | BINARY */
-
-    vector<BaseParser*> parsers;
-    llvm::BasicBlock* block = nullptr;
+    /* ARG = BINARY, which covers NAME, INTEGER and CALL */
 
 public:
-    ArgumentParser(llvm::BasicBlock* b);
-    virtual ~ArgumentParser() override final;
+    ArgumentParser(Arena* a=nullptr) : BaseParser(a) {}
+    virtual ~ArgumentParser() override final {}
 
     virtual ParseResult parse(CLIter, CLIter) const override final;
 };
@@ -101,58 +141,113 @@ public:
 
 class CallInstrParser final : public BaseParser {
     /*
-     * CALL = NAME + '(' + VOID | ARGS + ')' + EOL?
+     * CALL = NAME + '(' + VOID | ARGS + ')'
      * ARGS = ARG | ARG + ',' + ARGS
-     * ARG = NAME | INTEGER | CALL | BINARY
      * VOID =
     */
-    llvm::BasicBlock* block;
 
 public:
-    CallInstrParser(llvm::BasicBlock* basicblock) :
-        BaseParser(), block(basicblock) {}
+    CallInstrParser(Arena* a=nullptr) : BaseParser(a) {}
     virtual ~CallInstrParser() {}
 
     virtual ParseResult parse(CLIter, CLIter) const override final;
-
-private:
-    bool finish(CLIter, CLIter) const;
-    string takeName(CLIter, CLIter) const;
-    ParseResult takeArgument(CLIter, CLIter) const;
-    CLIter skipComma(CLIter) const;
 };
 
 
 class AssignValueParser final : public BaseParser {
-    /* VALUE = INTEGER | CALL | BINARY */
-
-    vector<BaseParser*> parsers;
-    llvm::BasicBlock* block = nullptr;
+    /* VALUE = BINARY, which covers INTEGER and CALL */
 
 public:
-    AssignValueParser(llvm::BasicBlock* basicBlock);
-    virtual ~AssignValueParser() override final;
+    AssignValueParser(Arena* a=nullptr) : BaseParser(a) {}
+    virtual ~AssignValueParser() override final {}
 
     virtual ParseResult parse(CLIter, CLIter) const override final;
 };
 
 
 class AssignInstrParser final : public BaseParser {
+    /* ASSIGN = NAME + '=' VALUE */
+
+public:
+    AssignInstrParser(Arena* a=nullptr) : BaseParser(a) {}
+    virtual ~AssignInstrParser() {}
+
+    virtual ParseResult parse(CLIter, CLIter) const override final;
+};
+
+
+class ReturnParser final : public BaseParser {
+    /* RETURN = 'return' + BINARY + EOL? */
+
+public:
+    ReturnParser(Arena* a=nullptr) : BaseParser(a) {}
+    ~ReturnParser() override {}
+
+    ParseResult parse(CLIter, CLIter) const override final;
+};
+
+
+class IfParser final : public BaseParser {
     /*
-     * ASSIGN = TYPE_NAME + NAME + '=' VALUE
-     * VALUE = INTEGER | CALL | BINARY
+     * IF = 'if' + BINARY + ':' + BODY + ('else' + ':' + BODY)?
+     * BODY = EOL + INDENT + (STATEMENT | EOL)+ + DEDENT
      */
 
-    llvm::BasicBlock* block;
+public:
+    IfParser(Arena* a=nullptr) : BaseParser(a) {}
+    ~IfParser() override {}
+
+    ParseResult parse(CLIter, CLIter) const override final;
+};
+
+
+class WhileParser final : public BaseParser {
+    /* WHILE = 'while' + BINARY + ':' + BODY */
+
+public:
+    WhileParser(Arena* a=nullptr) : BaseParser(a) {}
+    ~WhileParser() override {}
+
+    ParseResult parse(CLIter, CLIter) const override final;
+};
+
+
+class FunctionParser final : public BaseParser {
+    /* DEFINE = 'define' + NAME + '(' + VOID | NAMES + ')' + ':' + BODY */
+
+public:
+    FunctionParser(Arena* a=nullptr) : BaseParser(a) {}
+    ~FunctionParser() override {}
+
+    ParseResult parse(CLIter, CLIter) const override final;
+};
+
+
+class StatementParser final : public BaseParser {
+    /*
+     * STATEMENT = (ASSIGN | CALL) + EOL? | RETURN | IF | WHILE | DEFINE | EOL
+     * an empty line gives an empty result that still moves the cursor
+     */
 
 public:
-    AssignInstrParser(llvm::BasicBlock* b);
-    virtual ~AssignInstrParser();
+    StatementParser(Arena* a=nullptr) : BaseParser(a) {}
+    virtual ~StatementParser() override {}
 
     virtual ParseResult parse(CLIter, CLIter) const override final;
+};
 
-private:
-    string takeName(const CLIter, const CLIter) const;
-    CLIter skipAssignOperator(const CLIter) const;
-    ParseResult takeValue(const CLIter, const CLIter) const;
+
+class FlatStatementParser final {
+    /*
+     * (ASSIGN | CALL) + EOL? | EOL with the nodes appended to a FlatAST, a
+     * parsed statement becomes one of its roots; the flat tree holds no
+     * statements with bodies
+     */
+
+    FlatAST& tree;
+
+public:
+    explicit FlatStatementParser(FlatAST& t) : tree(t) {}
+
+    FlatParseResult parse(CLIter, CLIter) const;
 };
@@ -0,0 +1,247 @@
+#include <atomic>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #define SCAN_X86
+    #include <immintrin.h>
+#endif
+
+#include "scan.hpp"
+
+
+namespace {
+
+using Span = size_t (*)(const char*, const char*);
+using Find = size_t (*)(Tag, Tag, const Tag*, const Tag*);
+
+
+template<CharClass cls> size_t scalarSpan(const char* begin, const char* end) {
+    const char* cursor = begin;
+    while (cursor < end && inClass(cls, static_cast<unsigned char>(*cursor)))
+        ++cursor;
+    return cursor - begin;
+}
+
+size_t scalarFind(const Tag a, const Tag b, const Tag* begin, const Tag* end) {
+    const Tag* cursor = begin;
+    while (cursor < end && *cursor != a && *cursor != b)
+        ++cursor;
+    return cursor - begin;
+}
+
+
+#ifdef SCAN_X86
+
+/*
+ * Range checks on signed bytes: adding 0x80 - low maps [low, low + n) onto
+ * [-128, -128 + n), so one signed compare tells whether a byte is in range.
+ */
+inline __m128i inRange(const __m128i v, const char low, const char count) {
+    const __m128i shifted = _mm_add_epi8(v, _mm_set1_epi8(char(0x80 - low)));
+    return _mm_cmplt_epi8(shifted, _mm_set1_epi8(char(-128 + count)));
+}
+
+template<CharClass cls> inline __m128i classify(const __m128i v) {
+    switch (cls) {
+        case CharClass::DIGIT:
+            return inRange(v, '0', 10);
+        case CharClass::WORD:
+            return _mm_or_si128(
+                _mm_or_si128(inRange(v, '0', 10),
+                    inRange(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 26)),
+                _mm_cmpeq_epi8(v, _mm_set1_epi8('_'))
+            );
+        case CharClass::SPACE:
+            return _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+        default:
+            return _mm_setzero_si128();
+    }
+}
+
+template<CharClass cls> size_t sse2Span(const char* begin, const char* end) {
+    const char* cursor = begin;
+    for (; end - cursor >= 16; cursor += 16) {
+        const __m128i v = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(cursor)
+        );
+        const unsigned int outside =
+            ~_mm_movemask_epi8(classify<cls>(v)) & 0xFFFF;
+        if (outside != 0)
+            return cursor - begin + __builtin_ctz(outside);
+    }
+    return cursor - begin + scalarSpan<cls>(cursor, end);
+}
+
+
+__attribute__((target("avx2")))
+inline __m256i inRange256(const __m256i v, const char low, const char count) {
+    const __m256i shifted =
+        _mm256_add_epi8(v, _mm256_set1_epi8(char(0x80 - low)));
+    return _mm256_cmpgt_epi8(_mm256_set1_epi8(char(-128 + count)), shifted);
+}
+
+template<CharClass cls> __attribute__((target("avx2")))
+inline __m256i classify256(const __m256i v) {
+    switch (cls) {
+        case CharClass::DIGIT:
+            return inRange256(v, '0', 10);
+        case CharClass::WORD:
+            return _mm256_or_si256(
+                _mm256_or_si256(inRange256(v, '0', 10), inRange256(
+                    _mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 26)),
+                _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'))
+            );
+        case CharClass::SPACE:
+            return _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '));
+        default:
+            return _mm256_setzero_si256();
+    }
+}
+
+template<CharClass cls> __attribute__((target("avx2")))
+size_t avx2Span(const char* begin, const char* end) {
+    const char* cursor = begin;
+    for (; end - cursor >= 32; cursor += 32) {
+        const __m256i v = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(cursor)
+        );
+        const unsigned int outside = ~static_cast<unsigned int>(
+            _mm256_movemask_epi8(classify256<cls>(v))
+        );
+        if (outside != 0)
+            return cursor - begin + __builtin_ctz(outside);
+    }
+    return cursor - begin + sse2Span<cls>(cursor, end);
+}
+
+
+/* eight tags a compare, a match sets both bytes of its word in the mask */
+size_t sse2Find(const Tag a, const Tag b, const Tag* begin, const Tag* end) {
+    const __m128i first = _mm_set1_epi16(static_cast<short>(a));
+    const __m128i second = _mm_set1_epi16(static_cast<short>(b));
+    const Tag* cursor = begin;
+    for (; end - cursor >= 8; cursor += 8) {
+        const __m128i v = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(cursor)
+        );
+        const unsigned int found = _mm_movemask_epi8(_mm_or_si128(
+            _mm_cmpeq_epi16(v, first), _mm_cmpeq_epi16(v, second)));
+        if (found != 0)
+            return cursor - begin + __builtin_ctz(found) / 2;
+    }
+    return cursor - begin + scalarFind(a, b, cursor, end);
+}
+
+__attribute__((target("avx2")))
+size_t avx2Find(const Tag a, const Tag b, const Tag* begin, const Tag* end) {
+    const __m256i first = _mm256_set1_epi16(static_cast<short>(a));
+    const __m256i second = _mm256_set1_epi16(static_cast<short>(b));
+    const Tag* cursor = begin;
+    for (; end - cursor >= 16; cursor += 16) {
+        const __m256i v = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(cursor)
+        );
+        const unsigned int found = _mm256_movemask_epi8(_mm256_or_si256(
+            _mm256_cmpeq_epi16(v, first), _mm256_cmpeq_epi16(v, second)));
+        if (found != 0)
+            return cursor - begin + __builtin_ctz(found) / 2;
+    }
+    return cursor - begin + sse2Find(a, b, cursor, end);
+}
+
+#endif
+
+
+/* indexed by CharClass */
+struct Dispatch {
+    Isa isa = Isa::SCALAR;
+    Span spans[4] = {
+        scalarSpan<CharClass::NONE>, scalarSpan<CharClass::DIGIT>,
+        scalarSpan<CharClass::WORD>, scalarSpan<CharClass::SPACE>,
+    };
+    Find find = scalarFind;
+};
+
+Dispatch makeDispatch(const Isa isa) {
+    Dispatch dispatch;
+    dispatch.isa = isa;
+#ifdef SCAN_X86
+    if (isa == Isa::SSE2) {
+        dispatch.spans[1] = sse2Span<CharClass::DIGIT>;
+        dispatch.spans[2] = sse2Span<CharClass::WORD>;
+        dispatch.spans[3] = sse2Span<CharClass::SPACE>;
+        dispatch.find = sse2Find;
+    }
+    if (isa == Isa::AVX2) {
+        dispatch.spans[1] = avx2Span<CharClass::DIGIT>;
+        dispatch.spans[2] = avx2Span<CharClass::WORD>;
+        dispatch.spans[3] = avx2Span<CharClass::SPACE>;
+        dispatch.find = avx2Find;
+    }
+#endif
+    return dispatch;
+}
+
+const Dispatch& table(const Isa isa) {
+    static const Dispatch tables[] = {
+        makeDispatch(Isa::SCALAR), makeDispatch(Isa::SSE2),
+        makeDispatch(Isa::AVX2),
+    };
+    return tables[static_cast<unsigned char>(isa)];
+}
+
+/*
+ * The tables never change, only which one is current: useIsa() on one
+ * thread swaps the pointer while pool threads go on scanning, each call
+ * with whichever table it loaded.
+ */
+std::atomic<const Dispatch*>& current() {
+    static std::atomic<const Dispatch*> dispatch{&table(detectIsa())};
+    return dispatch;
+}
+
+const Dispatch& dispatch() {
+    return *current().load(std::memory_order_acquire);
+}
+
+}
+
+
+bool inClass(const CharClass cls, const unsigned char c) {
+    switch (cls) {
+        case CharClass::DIGIT:
+            return c >= '0' && c <= '9';
+        case CharClass::WORD:
+            return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') ||
+                (c >= 'A' && c <= 'Z') || c == '_';
+        case CharClass::SPACE:
+            return c == ' ';
+        default:
+            return false;
+    }
+}
+
+size_t span(const CharClass cls, const char* begin, const char* end) {
+    return dispatch().spans[static_cast<unsigned char>(cls)](begin, end);
+}
+
+size_t findTag(const Tag a, const Tag b, const Tag* begin, const Tag* end) {
+    return dispatch().find(a, b, begin, end);
+}
+
+Isa detectIsa() {
+#ifdef SCAN_X86
+    if (__builtin_cpu_supports("avx2")) return Isa::AVX2;
+    if (__builtin_cpu_supports("sse2")) return Isa::SSE2;
+#endif
+    return Isa::SCALAR;
+}
+
+Isa currentIsa() { return dispatch().isa; }
+
+bool useIsa(const Isa isa) {
+    if (static_cast<unsigned char>(isa) >
+        static_cast<unsigned char>(detectIsa()))
+            return false;
+    current().store(&table(isa), std::memory_order_release);
+    return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+
+
+/* character classes behind the runs the lexer spends its time on */
+enum class CharClass : unsigned char {
+    NONE = 0,
+    DIGIT = 1,      //\d
+    WORD = 2,       //\w
+    SPACE = 3,      //[ ]
+};
+
+enum class Isa : unsigned char {
+    SCALAR = 0,
+    SSE2 = 1,
+    AVX2 = 2,
+};
+
+/* lexer.hpp has the tags, scans only compare them as 16 bit words */
+enum class Tag : unsigned short;
+
+bool inClass(const CharClass cls, const unsigned char c);
+
+/* length of the run of `cls` bytes at the start of [begin, end) */
+size_t span(const CharClass cls, const char* begin, const char* end);
+
+/* index of the first tag in [begin, end) equal to a or b, or end - begin */
+size_t findTag(const Tag a, const Tag b, const Tag* begin, const Tag* end);
+
+/* best instruction set of this cpu, picked for the scans on first use */
+Isa detectIsa();
+Isa currentIsa();
+/*
+ * Force an implementation, returns false if the cpu lacks it. Scans on
+ * other threads may go on meanwhile, each with either implementation.
+ */
+bool useIsa(const Isa isa);
@@ -0,0 +1,35 @@
+#include <cassert>
+
+#include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/Function.h>
+
+#include "session.hpp"
+
+
+Session::Session(StringRef name) : context(new llvm::LLVMContext)
+    , module(new llvm::Module(name, *context))
+    , builder(new llvm::IRBuilder<>(*context)) {}
+
+Session::~Session() = default;
+
+llvm::BasicBlock* Session::function(StringRef name) {
+    llvm::Function* function = llvm::Function::Create(
+        llvm::FunctionType::get(llvm::Type::getInt32Ty(*context), false),
+        llvm::Function::ExternalLinkage, name, *module);
+    llvm::BasicBlock* entry =
+        llvm::BasicBlock::Create(*context, "entry", function);
+    builder->SetInsertPoint(entry);
+    return entry;
+}
+
+unique_ptr<llvm::Module> Session::takeModule() {
+    assert(module != nullptr);
+    builder.reset();
+    locals.clear();
+    return std::move(module);
+}
+
+unique_ptr<llvm::LLVMContext> Session::takeContext() {
+    assert(module == nullptr && "take the module first");
+    return std::move(context);
+}
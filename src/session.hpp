@@ -0,0 +1,55 @@
+#pragma once
+
+#include <memory>
+using std::unique_ptr;
+#include <string>
+using std::string;
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/StringRef.h>
+using llvm::StringRef;
+#include <llvm/IR/BasicBlock.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+
+#include "symbol.hpp"
+
+
+/*
+ * One compilation: the LLVM context, the module generated into and the
+ * builder codegen goes through. Nothing of it is shared, so sessions on
+ * different threads compile independently. Blocks and functions made for
+ * a session have to die with it or go to the jit with its module.
+ */
+class Session {
+public:
+    /* the slot of a local or an argument, by function and symbol */
+    using Locals = llvm::DenseMap<
+        std::pair<const llvm::Function*, Symbol>, llvm::Value*>;
+
+private:
+    unique_ptr<llvm::LLVMContext> context;
+    unique_ptr<llvm::Module> module;
+    unique_ptr<llvm::IRBuilder<>> builder;
+    /* shared by every codegen into the session, tree or flat */
+    Locals locals;
+
+public:
+    explicit Session(StringRef name="unnamed");
+    Session(const Session&) = delete;
+    Session& operator = (const Session&) = delete;
+    ~Session();
+
+    llvm::LLVMContext& getContext() { return *context; }
+    llvm::Module& getModule() { return *module; }
+    llvm::IRBuilder<>& getBuilder() { return *builder; }
+    Locals& getLocals() { return locals; }
+
+    /* a new int() function of the module, the builder at its entry block */
+    llvm::BasicBlock* function(StringRef name);
+
+    /* the module and its context, for the jit; the session is done after */
+    unique_ptr<llvm::Module> takeModule();
+    unique_ptr<llvm::LLVMContext> takeContext();
+};
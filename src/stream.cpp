@@ -0,0 +1,148 @@
+#include <cassert>
+#include <system_error>
+
+#include "stream.hpp"
+
+
+LexemStream::LexemStream(
+    std::unique_ptr<llvm::MemoryBuffer> buffer, const Lexer& l
+) : lexer(l), mapped(std::move(buffer)) {
+    assert(mapped != nullptr);
+}
+
+LexemStream::LexemStream(std::istream& in, const Lexer& l, size_t chunk) :
+    lexer(l), input(&in), chunkSize(chunk) {
+        assert(chunkSize > 0);
+}
+
+LexemStream LexemStream::fromFile(const string& path, const Lexer& l) {
+    auto buffer = llvm::MemoryBuffer::getFile(path, false, false);
+    if (!buffer)
+        throw std::system_error(buffer.getError(), path);
+    return LexemStream(std::move(buffer.get()), l);
+}
+
+
+const char* LexemStream::data() const {
+    return mapped != nullptr ? mapped->getBufferStart() : window.data();
+}
+
+size_t LexemStream::dataEnd() const {
+    return mapped != nullptr ? mapped->getBufferSize() :
+        windowStart + window.size();
+}
+
+bool LexemStream::refill() {
+    if (input == nullptr || !*input) return false;
+
+    const size_t size = window.size();
+    window.resize(size + chunkSize);
+    input->read(&window[size], chunkSize);
+    window.resize(size + input->gcount());
+    return window.size() > size;
+}
+
+void LexemStream::compact() {
+    /* drop consumed bytes once they outweigh a chunk, not on every call */
+    if (mapped != nullptr || position - windowStart < chunkSize) return;
+    window.erase(0, position - windowStart);
+    windowStart = position;
+}
+
+
+bool LexemStream::scan(Scanned& result) {
+    const unsigned int width = Lexer::INDENT_WIDTH;
+    while (true) {
+        /* indentation one lexem at a time, nothing behind position is kept */
+        if (level < target) {
+            result = {Tag::INDENT, position, width};
+            position = ++level < target ? position + width : content;
+            return true;
+        }
+        if (level > target) {
+            result = {Tag::DEDENT, position, 0};
+            --level;
+            return true;
+        }
+        if (lineStart) {
+            indent();
+            continue;
+        }
+
+        if (position == dataEnd() && !refill()) {
+            /* levels still open are closed at the end */
+            if (level == 0) return false;
+            target = 0;
+            continue;
+        }
+
+        const char* begin = data() + (position - windowStart);
+        const char* end = data() + (dataEnd() - windowStart);
+        const Automaton::Match match = lexer.match(begin, end);
+        if (match.partial && refill())
+            continue;
+        if (match.isEmpty() || match.length == 0)
+            throw SyntaxError();
+
+        const Tag tag = lexer.getTag(match, begin);
+        const size_t start = position;
+        position += match.length;
+        lineStart = tag == Tag::EOL;
+        if (tag != Tag::SEPARATOR) {
+            result = {tag, start, match.length};
+            return true;
+        }
+    }
+}
+
+void LexemStream::indent() {
+    /* the leading spaces and the byte after them have to be in the window */
+    size_t run = 0;
+    while (true) {
+        const char* begin = data() + (position - windowStart);
+        const char* end = data() + (dataEnd() - windowStart);
+        run = span(CharClass::SPACE, begin, end);
+        if (begin + run < end || !refill()) break;
+    }
+    lineStart = false;
+    content = position + run;
+
+    const bool blank = content == dataEnd() ||
+        data()[content - windowStart] == '\n';
+    if (!blank) target = run / Lexer::INDENT_WIDTH;
+    /* INDENTs start at the first level opened, the rest go from content */
+    if (target > level) position += level * Lexer::INDENT_WIDTH;
+    else position = content;
+}
+
+Lexem LexemStream::make(const Scanned& lexem) const {
+    return Lexem(
+        StringRef(data() + (lexem.start - windowStart), lexem.length),
+        lexem.start, lexem.tag
+    );
+}
+
+
+bool LexemStream::next(Lexem& lexem) throw(SyntaxError) {
+    compact();
+    Scanned result;
+    if (!scan(result)) return false;
+    lexem = make(result);
+    return true;
+}
+
+bool LexemStream::nextLine(vector<Lexem>& line) throw(SyntaxError) {
+    compact();
+    scanned.clear();
+    Scanned result;
+    while (scan(result)) {
+        scanned.push_back(result);
+        if (result.tag == Tag::EOL) break;
+    }
+
+    /* the window may have moved while refilling, views are made last */
+    line.clear();
+    for (const Scanned& lexem: scanned)
+        line.push_back(make(lexem));
+    return !line.empty();
+}
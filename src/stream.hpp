@@ -0,0 +1,71 @@
+#pragma once
+
+#include <istream>
+#include <memory>
+
+#include <llvm/Support/MemoryBuffer.h>
+
+#include "lexer.hpp"
+
+
+/*
+ * Pull based lexer, the program is never held as one token vector.
+ * Input is either a mapped file or a stream read in fixed size chunks; in the
+ * latter case only the unconsumed tail of the last chunks is kept, a lexem
+ * cut by a chunk boundary is lexed again once the next chunk arrived.
+ *
+ * Lexems point into the stream's buffer: the one from next() is valid until
+ * the following call, the ones from nextLine() until the next line is read.
+ */
+class LexemStream {
+    struct Scanned {
+        Tag tag;
+        size_t start;
+        unsigned int length;
+    };
+
+    const Lexer& lexer;
+    std::unique_ptr<llvm::MemoryBuffer> mapped;
+    std::istream* input = nullptr;
+    size_t chunkSize = 0;
+
+    /* chunked input: window holds source bytes from windowStart on */
+    string window;
+    size_t windowStart = 0;
+    size_t position = 0;
+    vector<Scanned> scanned;
+
+    /* levels open, those the current line asks for, where it starts */
+    unsigned int level = 0;
+    unsigned int target = 0;
+    bool lineStart = true;
+    size_t content = 0;
+
+public:
+    static const size_t CHUNK_SIZE = 64 * 1024;
+
+    explicit LexemStream(
+        std::unique_ptr<llvm::MemoryBuffer> buffer, const Lexer& l);
+    explicit LexemStream(
+        std::istream& in, const Lexer& l, size_t chunk=CHUNK_SIZE);
+    LexemStream(LexemStream&&) = default;
+    ~LexemStream() = default;
+
+    /* maps the whole file, throws std::system_error if it can not */
+    static LexemStream fromFile(const string& path, const Lexer& l);
+
+    bool next(Lexem&) throw(SyntaxError);
+    /* lexems up to and including the next Tag::EOL */
+    bool nextLine(vector<Lexem>&) throw(SyntaxError);
+
+    size_t getPosition() const { return position; }
+
+private:
+    const char* data() const;
+    size_t dataEnd() const;
+    bool refill();
+    void compact();
+    bool scan(Scanned&);
+    void indent();
+    Lexem make(const Scanned&) const;
+};
@@ -0,0 +1,53 @@
+#include <cassert>
+
+#include <llvm/Support/DJB.h>
+
+#include "symbol.hpp"
+
+
+StringRef Symbol::str() const {
+    return isEmpty() ? StringRef() : SymbolTable::global().name(*this);
+}
+
+
+Symbol intern(StringRef name) {
+    return SymbolTable::global().intern(name);
+}
+
+
+SymbolTable& SymbolTable::global() {
+    static SymbolTable table;
+    return table;
+}
+
+Symbol SymbolTable::intern(StringRef name) {
+    const unsigned int shard = llvm::djbHash(name) & (SHARDS - 1);
+    Shard& current = shards[shard];
+    std::lock_guard<std::mutex> guard(current.lock);
+
+    auto inserted = current.ids.try_emplace(name, 0);
+    if (inserted.second) {
+        current.names.push_back(inserted.first->getKey());
+        inserted.first->second =
+            (current.names.size() << SHARD_BITS) | shard;
+    }
+    return Symbol(inserted.first->second);
+}
+
+StringRef SymbolTable::name(const Symbol symbol) {
+    Shard& current = shards[symbol.getId() & (SHARDS - 1)];
+    std::lock_guard<std::mutex> guard(current.lock);
+
+    const size_t index = (symbol.getId() >> SHARD_BITS) - 1;
+    assert(index < current.names.size());
+    return current.names[index];
+}
+
+size_t SymbolTable::size() {
+    size_t result = 0;
+    for (Shard& shard: shards) {
+        std::lock_guard<std::mutex> guard(shard.lock);
+        result += shard.names.size();
+    }
+    return result;
+}
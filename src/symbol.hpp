@@ -0,0 +1,75 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+using std::vector;
+
+#include <llvm/ADT/DenseMapInfo.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+using llvm::StringRef;
+
+
+/* 32 bit id of an interned identifier, equal names share one id */
+class Symbol {
+    unsigned int id = 0;
+
+public:
+    Symbol() = default;
+    explicit Symbol(const unsigned int i) : id(i) {}
+
+    unsigned int getId() const { return id; }
+    bool isEmpty() const { return id == 0; }
+    /* the interned spelling, valid for the life of the program */
+    StringRef str() const;
+
+    bool operator == (const Symbol other) const { return id == other.id; }
+    bool operator != (const Symbol other) const { return id != other.id; }
+    bool operator < (const Symbol other) const { return id < other.id; }
+};
+
+
+Symbol intern(StringRef name);
+
+
+/*
+ * Process wide interner. It is split in shards with a lock each so that the
+ * parallel lexer rarely waits; the low bits of an id name its shard.
+ */
+class SymbolTable {
+    static const unsigned int SHARD_BITS = 6;
+    static const unsigned int SHARDS = 1 << SHARD_BITS;
+
+    struct Shard {
+        std::mutex lock;
+        llvm::StringMap<unsigned int> ids;
+        vector<StringRef> names;
+    };
+    Shard shards[SHARDS];
+
+    SymbolTable() = default;
+
+public:
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator = (const SymbolTable&) = delete;
+
+    static SymbolTable& global();
+
+    Symbol intern(StringRef name);
+    StringRef name(const Symbol symbol);
+    size_t size();
+};
+
+
+namespace llvm {
+template<> struct DenseMapInfo<Symbol> {
+    static Symbol getEmptyKey() { return Symbol(~0u); }
+    static Symbol getTombstoneKey() { return Symbol(~0u - 1); }
+    static unsigned getHashValue(const Symbol symbol) {
+        return symbol.getId() * 37u;
+    }
+    static bool isEqual(const Symbol left, const Symbol right) {
+        return left == right;
+    }
+};
+}
@@ -0,0 +1,55 @@
+#include <cassert>
+
+#include "scan.hpp"
+#include "tokens.hpp"
+
+
+void TokenBuffer::push_back(const Lexem& lexem) {
+    assert(text != nullptr);
+    tags.push_back(lexem.getTag());
+    starts.push_back(lexem.getStart());
+    lengths.push_back(lexem.getLength());
+    symbols.push_back(lexem.getSymbol());
+}
+
+void TokenBuffer::reserve(const size_t count) {
+    tags.reserve(count);
+    starts.reserve(count);
+    lengths.reserve(count);
+    symbols.reserve(count);
+}
+
+void TokenBuffer::clear() {
+    tags.clear();
+    starts.clear();
+    lengths.clear();
+    symbols.clear();
+}
+
+Lexem TokenBuffer::getLexem(const size_t i) const {
+    return Lexem(text, starts[i], starts[i] + lengths[i], tags[i], symbols[i]);
+}
+
+vector<Lexem> TokenBuffer::toLexems() const {
+    vector<Lexem> lexems;
+    lexems.reserve(size());
+    for (size_t i = 0; i < size(); ++i)
+        lexems.push_back(getLexem(i));
+    return lexems;
+}
+
+size_t TokenBuffer::getBytes() const {
+    return tags.capacity() * sizeof(Tag) +
+        (starts.capacity() + lengths.capacity()) * sizeof(uint32_t) +
+        symbols.capacity() * sizeof(Symbol);
+}
+
+
+size_t TokenBuffer::find(const Tag tag, const size_t from) const {
+    if (from >= size()) return size();
+    return from + findTag(tag, tag, tags.data() + from, tags.data() + size());
+}
+
+size_t TokenBuffer::lineEnd(const size_t from) const {
+    return find(Tag::EOL, from);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+using std::vector;
+
+#include "lexer.hpp"
+
+
+/*
+ * The lexems of a source as parallel arrays: a tag, an offset and a length
+ * per lexem, and the symbol of the names. Scans over the tags alone touch
+ * 2 bytes a lexem instead of a whole Lexem, and compare a vector register
+ * of tags at once. The source has to outlive the buffer.
+ */
+class TokenBuffer {
+    const char* text = nullptr;
+    vector<Tag> tags;
+    vector<uint32_t> starts;
+    vector<uint32_t> lengths;
+    vector<Symbol> symbols;
+
+public:
+    TokenBuffer() = default;
+    explicit TokenBuffer(const string& source) : text(source.data()) {}
+
+    void push_back(const Lexem& lexem);
+    void reserve(const size_t count);
+    void clear();
+
+    size_t size() const { return tags.size(); }
+    bool empty() const { return tags.empty(); }
+    const Tag* getTags() const { return tags.data(); }
+    Tag getTag(const size_t i) const { return tags[i]; }
+    uint32_t getStart(const size_t i) const { return starts[i]; }
+    uint32_t getLength(const size_t i) const { return lengths[i]; }
+    Symbol getSymbol(const size_t i) const { return symbols[i]; }
+
+    /* the same lexem the lexer made, no name interned again */
+    Lexem getLexem(const size_t i) const;
+    vector<Lexem> toLexems() const;
+    /* bytes held by the arrays, spare capacity included */
+    size_t getBytes() const;
+
+    /* first lexem tagged `tag` at or after from, size() for none */
+    size_t find(const Tag tag, const size_t from=0) const;
+    /* the EOL ending the line of from, or size() on the last line */
+    size_t lineEnd(const size_t from) const;
+};
@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <exception>
+#include <future>
+
+#include "unit.hpp"
+#include "visitor.hpp"
+
+
+CompilationUnit::CompilationUnit(string source, const Lexer& lexer) :
+    text(std::move(source)), statements(ArenaAllocator<BaseAST*>(&arena)) {
+    lexer.tokenize(text, tokens);
+    lexems = tokens.toLexems();
+}
+
+void CompilationUnit::parse() {
+    reset();
+    const StatementParser parser(&arena);
+    for (CLIter cursor = lexems.begin(); cursor != lexems.end(); ) {
+        const ParseResult result = parser.parse(cursor, lexems.end());
+        if (!result.isEmpty()) statements.push_back(result.ast);
+        cursor = result.cursor;
+    }
+}
+
+void CompilationUnit::parse(llvm::ThreadPool& pool, const size_t minChunk) {
+    reset();
+    const vector<size_t> bounds = split(std::max<size_t>(1, std::min<size_t>(
+        pool.getThreadCount() * 4,
+        lexems.size() / std::max<size_t>(minChunk, 1)
+    )));
+
+    /* a statement never spans a bound, so a chunk parses as in the whole */
+    for (size_t i = 1; i < bounds.size(); ++i)
+        chunks.push_back(unique_ptr<Arena>(new Arena));
+    vector<vector<BaseAST*>> parts(bounds.size() - 1);
+    vector<std::exception_ptr> errors(parts.size());
+    vector<std::shared_future<void>> done;
+    for (size_t i = 0; i < parts.size(); ++i) {
+        done.push_back(pool.async([&, i] {
+            try {
+                const StatementParser parser(chunks[i].get());
+                const CLIter end = lexems.begin() + bounds[i + 1];
+                for (CLIter cursor = lexems.begin() + bounds[i];
+                    cursor != end; ) {
+                    const ParseResult result = parser.parse(cursor, end);
+                    if (!result.isEmpty()) parts[i].push_back(result.ast);
+                    cursor = result.cursor;
+                }
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }));
+    }
+    for (auto& part: done)
+        part.wait();
+
+    /*
+     * the first error in source order is the one a serial parse stops at,
+     * the statements before it are kept as that parse keeps them
+     */
+    size_t parsed = 0, total = 0;
+    while (parsed < parts.size() && !errors[parsed])
+        total += parts[parsed++].size();
+    if (parsed < parts.size()) total += parts[parsed].size();
+    statements.reserve(total);
+    for (size_t i = 0; i < parts.size() && i <= parsed; ++i)
+        statements.insert(statements.end(), parts[i].begin(), parts[i].end());
+    if (parsed < parts.size()) std::rethrow_exception(errors[parsed]);
+}
+
+void CompilationUnit::reset() {
+    /* the vector lives in the arena, so it goes before the arena does */
+    statements = vector<BaseAST*, ArenaAllocator<BaseAST*>>(
+        ArenaAllocator<BaseAST*>(&arena));
+    arena.reset();
+    chunks.clear();
+}
+
+void CompilationUnit::codegen(Session& session) {
+    CodegenVisitor visitor(session);
+    for (size_t i = 0; i < statements.size(); ++i)
+        if (visitor.visit(*statements[i]) == nullptr)
+            throw CodegenError(i, "no IR for " + statements[i]->str());
+
+    string errors;
+    if (!verify(session.getModule(), &errors))
+        throw CodegenError(statements.size(), errors);
+}
+
+size_t CompilationUnit::getNodes() const {
+    size_t nodes = arena.getNodes();
+    for (const unique_ptr<Arena>& chunk: chunks)
+        nodes += chunk->getNodes();
+    return nodes;
+}
+
+/*
+ * Lexem indexes splitting the unit into at most `count` runs of whole top
+ * level statements. A bound is where the serial parse would start the next
+ * statement: the first lexem of a line that is not indented, so the bodies
+ * of a block stay with the line that opens it and the DEDENTs closing them
+ * come before the bound. An else is no bound, it continues its if.
+ */
+bool CompilationUnit::opensStatement(const size_t i) const {
+    const size_t start = tokens.getStart(i);
+    if (start == 0 || text[start - 1] != '\n') return false;
+    switch (tokens.getTag(i)) {
+        case Tag::NAME:
+            return true;
+        case Tag::KEYWORD:
+            return StringRef(text).substr(start, tokens.getLength(i)) !=
+                KEYWORDS[static_cast<size_t>(Keyword::ELSE)];
+        default:
+            return false;
+    }
+}
+
+vector<size_t> CompilationUnit::split(const size_t count) const {
+    vector<size_t> bounds = {0};
+    for (size_t i = 1; i < count; ++i) {
+        size_t at = std::max(tokens.size() / count * i, bounds.back() + 1);
+        /*
+         * a line opens after an EOL and the DEDENTs behind it, the lines of
+         * a body are skipped an EOL at a time over the tag column
+         */
+        while (at < tokens.size() && tokens.getTag(at) == Tag::DEDENT) ++at;
+        while (at < tokens.size() && !opensStatement(at)) {
+            at = tokens.lineEnd(at) + 1;
+            while (at < tokens.size() && tokens.getTag(at) == Tag::DEDENT)
+                ++at;
+        }
+        if (at >= tokens.size()) break;
+        bounds.push_back(at);
+    }
+    bounds.push_back(tokens.size());
+    return bounds;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <memory>
+using std::unique_ptr;
+
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "tokens.hpp"
+
+
+/*
+ * owns the program text and its AST: every Lexem of the unit is a view into
+ * the text and every node lives in the arena of the unit
+ */
+class CompilationUnit {
+    const string text;
+    /* the lexems in columns, the tags are scanned for statement bounds */
+    TokenBuffer tokens;
+    vector<Lexem> lexems;
+    Arena arena;
+    /* one per chunk of the last parallel parse */
+    vector<unique_ptr<Arena>> chunks;
+    vector<BaseAST*, ArenaAllocator<BaseAST*>> statements;
+
+public:
+    static const size_t PARALLEL_CHUNK = 1 << 14;
+
+    explicit CompilationUnit(string source, const Lexer& lexer=Lexer());
+    CompilationUnit(const CompilationUnit&) = delete;
+    CompilationUnit& operator = (const CompilationUnit&) = delete;
+    ~CompilationUnit() = default;
+
+    /*
+     * parses the top level statements, ParseError on the first bad one with
+     * the statements before it kept; the tree of an earlier parse is freed
+     */
+    void parse();
+    /* same statements, chunks of at least minChunk lexems parsed on the pool */
+    void parse(llvm::ThreadPool& pool, const size_t minChunk=PARALLEL_CHUNK);
+
+    /*
+     * IR of the parsed statements through one CodegenVisitor: definitions
+     * go to the module of the session, anything else is appended where its
+     * builder is, Session::function() for one, and has to end with a
+     * return there. Throws CodegenError for a statement that gives no IR or
+     * a module that does not verify.
+     */
+    void codegen(Session&);
+
+    const string& getSource() const { return text; }
+    const vector<Lexem>& getLexems() const { return lexems; }
+    const TokenBuffer& getTokens() const { return tokens; }
+    const vector<BaseAST*, ArenaAllocator<BaseAST*>>& getStatements() const {
+        return statements;
+    }
+    const Arena& getArena() const { return arena; }
+    /* AST nodes placed by either parse, chunk arenas included */
+    size_t getNodes() const;
+
+private:
+    /* drops the statements and the arenas of the last parse */
+    void reset();
+    bool opensStatement(const size_t) const;
+    vector<size_t> split(const size_t count) const;
+};
@@ -0,0 +1,393 @@
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/ValueSymbolTable.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include "visitor.hpp"
+
+
+void PrintVisitor::visitInteger(const IntegerAST& node) {
+    out += "[IntegerAST: ";
+    out += std::to_string(node.getValue());
+    out += "]";
+}
+
+void PrintVisitor::visitName(const NameAST& node) {
+    out += "[Name: ";
+    out += node.getName().str();
+    out += " of ";
+    out += node.getType()->str();
+    out += "]";
+}
+
+void PrintVisitor::visitBinary(const BinaryInstrAST& node) {
+    out += "[BinaryInstrAST: ";
+    out += toString(node.getOpCode());
+    out += " ";
+    visit(*node.getLeft());
+    out += " ";
+    visit(*node.getRight());
+    out += "]";
+}
+
+void PrintVisitor::visitCall(const CallInstrAST& node) {
+    out += "[CallInstrAST: '";
+    out += node.getName().str();
+    out += "' (";
+    const CallInstrAST::Arguments& arguments = node.getArguments();
+    for (size_t i = 0; i < arguments.size(); ++i) {
+        if (i > 0) out += ", ";
+        visit(*arguments[i]);
+    }
+    out += ")]";
+}
+
+void PrintVisitor::visitAssign(const AssignInstrAST& node) {
+    out += "[AssignInstrAST: ";
+    out += node.getName().str();
+    out += " = ";
+    visit(*node.getValue());
+    out += "]";
+}
+
+void PrintVisitor::visitPrototype(const PrototypeAST& node) {
+    out += "[PrototypeAST: '";
+    out += node.getName().str();
+    out += "' (";
+    const PrototypeAST::Arguments& arguments = node.getArguments();
+    for (size_t i = 0; i < arguments.size(); ++i) {
+        if (i > 0) out += ", ";
+        out += arguments[i].str();
+    }
+    out += ")]";
+}
+
+void PrintVisitor::visitReturn(const ReturnAST& node) {
+    out += "[ReturnAST: ";
+    visit(*node.getValue());
+    out += "]";
+}
+
+void PrintVisitor::visitIf(const IfAST& node) {
+    out += "[IfAST: ";
+    visit(*node.getCondition());
+    out += " then ";
+    visitBody(node.getBody());
+    out += " else ";
+    visitBody(node.getElse());
+    out += "]";
+}
+
+void PrintVisitor::visitWhile(const WhileAST& node) {
+    out += "[WhileAST: ";
+    visit(*node.getCondition());
+    out += " do ";
+    visitBody(node.getBody());
+    out += "]";
+}
+
+void PrintVisitor::visitFunction(const FunctionAST& node) {
+    out += "[FunctionAST: ";
+    visit(*node.getPrototype());
+    out += " ";
+    visitBody(node.getBody());
+    out += "]";
+}
+
+void PrintVisitor::visitBody(const Statements& body) {
+    out += "(";
+    for (size_t i = 0; i < body.size(); ++i) {
+        if (i > 0) out += ", ";
+        visit(*body[i]);
+    }
+    out += ")";
+}
+
+
+
+
+CodegenVisitor::CodegenVisitor(Session& s) : session(s)
+    , builder(s.getBuilder()) {}
+
+llvm::Module* CodegenVisitor::getModule() const {
+    Block* block = builder.GetInsertBlock();
+    if (block != nullptr && block->getParent() != nullptr)
+        return block->getModule();
+    return &session.getModule();
+}
+
+bool CodegenVisitor::terminated() const {
+    return builder.GetInsertBlock()->getTerminator() != nullptr;
+}
+
+llvm::Value* CodegenVisitor::slot(const Symbol name, const bool make) {
+    Block* block = builder.GetInsertBlock();
+    llvm::Function* function = block->getParent();
+    Session::Locals& locals = session.getLocals();
+    auto local = locals.find({function, name});
+    if (local != locals.end()) return local->second;
+    if (!make) return nullptr;
+
+    /*
+     * Slots go first in the entry block, where one alloca serves every
+     * store of a loop. No data layout is needed, so blocks may live
+     * outside a module.
+     */
+    auto* variable = new llvm::AllocaInst(builder.getInt32Ty(), 0, nullptr,
+        llvm::Align(4), name.str());
+    if (function != nullptr) {
+        Block& entry = function->getEntryBlock();
+        entry.getInstList().insert(entry.getFirstInsertionPt(), variable);
+    } else {
+        builder.Insert(variable);
+    }
+    locals[{function, name}] = variable;
+    return variable;
+}
+
+llvm::Value* CodegenVisitor::visitInteger(const IntegerAST& node) {
+    return integer(node.getValue());
+}
+
+llvm::Value* CodegenVisitor::integer(const int value) {
+    return builder.getInt32(value);
+}
+
+llvm::Value* CodegenVisitor::visitName(const NameAST& node) {
+    return load(node.getName());
+}
+
+llvm::Value* CodegenVisitor::load(const Symbol name) {
+    Block* block = place();
+    if (block == nullptr) return nullptr;
+    llvm::Value* value = slot(name, false);
+    if (value != nullptr)
+        return builder.CreateLoad(builder.getInt32Ty(), value,
+            name.str() + ".load");
+
+    /* arguments of a function the AST did not make itself */
+    if (llvm::Function* function = block->getParent())
+        for (llvm::Argument& argument: function->args())
+            if (argument.getName() == name.str()) return &argument;
+    return nullptr;
+}
+
+llvm::Value* CodegenVisitor::divide(llvm::Value* left, llvm::Value* right) {
+    /*
+     * sdiv by 0 or of INT_MIN by -1 traps on the host, both get a value
+     * instead: 0 for a 0 divisor, the wrapped negation for -1. A constant
+     * divisor picks its case here, any other is checked when run.
+     */
+    if (auto* constant = llvm::dyn_cast<llvm::ConstantInt>(right)) {
+        if (constant->isZero()) return builder.getInt32(0);
+        if (constant->isMinusOne()) return builder.CreateNeg(left);
+        return builder.CreateSDiv(left, right);
+    }
+    llvm::Value* zero = builder.CreateICmpEQ(right, builder.getInt32(0));
+    llvm::Value* minus = builder.CreateICmpEQ(right, builder.getInt32(-1));
+    llvm::Value* safe = builder.CreateSelect(builder.CreateOr(zero, minus),
+        builder.getInt32(1), right);
+    llvm::Value* quotient = builder.CreateSDiv(left, safe);
+    quotient = builder.CreateSelect(minus,
+        builder.CreateSub(builder.getInt32(0), left), quotient);
+    return builder.CreateSelect(zero, builder.getInt32(0), quotient);
+}
+
+llvm::Value* CodegenVisitor::visitBinary(const BinaryInstrAST& node) {
+    if (place() == nullptr) return nullptr;
+    llvm::Value* left = visit(*node.getLeft());
+    llvm::Value* right = visit(*node.getRight());
+    return binary(node.getOpCode(), left, right);
+}
+
+llvm::Value* CodegenVisitor::binary(
+    const OpCode code, llvm::Value* left, llvm::Value* right
+) {
+    if (place() == nullptr || left == nullptr || right == nullptr)
+        return nullptr;
+    switch (code) {
+        case OpCode::ADD: return builder.CreateAdd(left, right);
+        case OpCode::SUB: return builder.CreateSub(left, right);
+        case OpCode::MUL: return builder.CreateMul(left, right);
+        case OpCode::DIV: return divide(left, right);
+        case OpCode::EQ:
+            return builder.CreateZExt(
+                builder.CreateICmpEQ(left, right), builder.getInt32Ty());
+        case OpCode::UNKNOWN: break;
+    }
+    return nullptr;
+}
+
+llvm::Value* CodegenVisitor::visitCall(const CallInstrAST& node) {
+    if (place() == nullptr) return nullptr;
+    llvm::Function* function =
+        callee(node.getName(), node.getArguments().size());
+    if (function == nullptr) return nullptr;
+
+    vector<llvm::Value*> arguments;
+    for (const BaseAST* argument: node.getArguments()) {
+        arguments.push_back(visit(*argument));
+        if (arguments.back() == nullptr) return nullptr;
+    }
+    return call(function, arguments);
+}
+
+llvm::Function* CodegenVisitor::callee(
+    const Symbol name, const size_t count
+) const {
+    llvm::Function* function = getModule()->getFunction(name.str());
+    return function != nullptr && function->arg_size() == count ?
+        function : nullptr;
+}
+
+llvm::Value* CodegenVisitor::call(
+    llvm::Function* function, llvm::ArrayRef<llvm::Value*> arguments
+) {
+    if (place() == nullptr) return nullptr;
+    return builder.CreateCall(function, arguments,
+        function->getName() + ".call");
+}
+
+llvm::Value* CodegenVisitor::visitAssign(const AssignInstrAST& node) {
+    if (place() == nullptr) return nullptr;
+    return store(node.getName(), visit(*node.getValue()));
+}
+
+llvm::Value* CodegenVisitor::store(const Symbol name, llvm::Value* value) {
+    if (place() == nullptr || value == nullptr) return nullptr;
+    return builder.CreateStore(value, slot(name, true));
+}
+
+llvm::Value* CodegenVisitor::visitPrototype(const PrototypeAST& node) {
+    llvm::Module* module = getModule();
+    const StringRef name = node.getName().str();
+    const size_t count = node.getArguments().size();
+    if (llvm::Function* known = module->getFunction(name))
+        return known->arg_size() == count ? known : nullptr;
+
+    llvm::Type* integer = llvm::Type::getInt32Ty(module->getContext());
+    const vector<llvm::Type*> types(count, integer);
+    llvm::Function* function = llvm::Function::Create(
+        llvm::FunctionType::get(integer, types, false),
+        llvm::Function::ExternalLinkage, name, module);
+    size_t i = 0;
+    for (llvm::Argument& argument: function->args())
+        argument.setName(node.getArguments()[i++].str());
+    return function;
+}
+
+llvm::Value* CodegenVisitor::visitReturn(const ReturnAST& node) {
+    if (place() == nullptr) return nullptr;
+    llvm::Value* value = visit(*node.getValue());
+    return value != nullptr ? builder.CreateRet(value) : nullptr;
+}
+
+llvm::Value* CodegenVisitor::condition(const BaseAST& node) {
+    llvm::Value* value = visit(node);
+    return value != nullptr ?
+        builder.CreateICmpNE(value, builder.getInt32(0), "cond") : nullptr;
+}
+
+llvm::Value* CodegenVisitor::visitIf(const IfAST& node) {
+    Block* block = place();
+    llvm::Function* function = block != nullptr ? block->getParent() : nullptr;
+    if (function == nullptr) return nullptr;
+    llvm::Value* test = condition(*node.getCondition());
+    if (test == nullptr) return nullptr;
+
+    llvm::LLVMContext& c = builder.getContext();
+    Block* then = Block::Create(c, "then", function);
+    /* in the function at once, an erased function takes it along */
+    Block* merge = Block::Create(c, "endif", function);
+    Block* otherwise = node.getElse().empty() ?
+        merge : Block::Create(c, "else", function);
+    llvm::Value* branch = builder.CreateCondBr(test, then, otherwise);
+
+    builder.SetInsertPoint(then);
+    if (!visitBody(node.getBody())) return nullptr;
+    if (!terminated()) builder.CreateBr(merge);
+    if (otherwise != merge) {
+        builder.SetInsertPoint(otherwise);
+        if (!visitBody(node.getElse())) return nullptr;
+        if (!terminated()) builder.CreateBr(merge);
+    }
+    /* both ways returned, the builder stays after the last return */
+    if (merge->hasNPredecessors(0)) {
+        merge->eraseFromParent();
+        return branch;
+    }
+    if (merge != &function->back()) merge->moveAfter(&function->back());
+    builder.SetInsertPoint(merge);
+    return branch;
+}
+
+llvm::Value* CodegenVisitor::visitWhile(const WhileAST& node) {
+    Block* block = place();
+    llvm::Function* function = block != nullptr ? block->getParent() : nullptr;
+    if (function == nullptr) return nullptr;
+
+    llvm::LLVMContext& c = builder.getContext();
+    Block* head = Block::Create(c, "while", function);
+    Block* body = Block::Create(c, "do", function);
+    Block* exit = Block::Create(c, "endwhile", function);
+    builder.CreateBr(head);
+
+    builder.SetInsertPoint(head);
+    llvm::Value* test = condition(*node.getCondition());
+    if (test == nullptr) return nullptr;
+    llvm::Value* branch = builder.CreateCondBr(test, body, exit);
+
+    builder.SetInsertPoint(body);
+    if (!visitBody(node.getBody())) return nullptr;
+    if (!terminated()) builder.CreateBr(head);
+    if (exit != &function->back()) exit->moveAfter(&function->back());
+    builder.SetInsertPoint(exit);
+    return branch;
+}
+
+llvm::Value* CodegenVisitor::visitFunction(const FunctionAST& node) {
+    auto* function = llvm::cast_or_null<llvm::Function>(
+        visitPrototype(*node.getPrototype()));
+    if (function == nullptr || !function->empty()) return nullptr;
+
+    /* a definition inside a body leaves the builder where it was */
+    const llvm::IRBuilderBase::InsertPointGuard guard(builder);
+    builder.SetInsertPoint(
+        Block::Create(builder.getContext(), "entry", function));
+    for (llvm::Argument& argument: function->args()) {
+        const Symbol name = intern(argument.getName());
+        builder.CreateStore(&argument, slot(name, true));
+    }
+
+    /* falling off the end returns 0 */
+    const bool generated = visitBody(node.getBody());
+    if (generated && !terminated()) builder.CreateRet(builder.getInt32(0));
+    if (!generated || llvm::verifyFunction(*function)) {
+        /* erasing leaves tombstones, the iteration goes on */
+        Session::Locals& locals = session.getLocals();
+        for (auto local = locals.begin(); local != locals.end(); ++local)
+            if (local->first.first == function) locals.erase(local);
+        function->eraseFromParent();
+        return nullptr;
+    }
+    return function;
+}
+
+bool CodegenVisitor::visitBody(const Statements& body) {
+    for (const BaseAST* statement: body) {
+        if (terminated()) break;
+        if (visit(*statement) == nullptr) return false;
+    }
+    return true;
+}
+
+
+bool verify(const llvm::Module& module, string* errors) {
+    string found;
+    llvm::raw_string_ostream out(found);
+    const bool broken = llvm::verifyModule(module, &out);
+    if (errors != nullptr) *errors = out.str();
+    return !broken;
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <string>
+using std::string;
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/Support/ErrorHandling.h>
+
+#include "ast.hpp"
+
+
+using Block = llvm::BasicBlock;
+
+
+/*
+ * Static dispatch over the node kinds: a pass derives from Visitor<Pass,
+ * Result> and defines a visit<Kind> member for every kind. visit() switches
+ * on the kind of the node once and calls the pass without any virtual call
+ * or RTTI, so a new pass needs no change to the node classes.
+ */
+template<typename Pass, typename Result> class Visitor {
+public:
+    Result visit(const BaseAST& node) {
+        Pass& pass = static_cast<Pass&>(*this);
+        switch (node.getKind()) {
+            case NodeKind::INTEGER:
+                return pass.visitInteger(static_cast<const IntegerAST&>(node));
+            case NodeKind::NAME:
+                return pass.visitName(static_cast<const NameAST&>(node));
+            case NodeKind::BINARY:
+                return pass.visitBinary(
+                    static_cast<const BinaryInstrAST&>(node));
+            case NodeKind::CALL:
+                return pass.visitCall(static_cast<const CallInstrAST&>(node));
+            case NodeKind::ASSIGN:
+                return pass.visitAssign(
+                    static_cast<const AssignInstrAST&>(node));
+            case NodeKind::PROTOTYPE:
+                return pass.visitPrototype(
+                    static_cast<const PrototypeAST&>(node));
+            case NodeKind::RETURN:
+                return pass.visitReturn(static_cast<const ReturnAST&>(node));
+            case NodeKind::IF:
+                return pass.visitIf(static_cast<const IfAST&>(node));
+            case NodeKind::WHILE:
+                return pass.visitWhile(static_cast<const WhileAST&>(node));
+            case NodeKind::FUNCTION:
+                return pass.visitFunction(
+                    static_cast<const FunctionAST&>(node));
+        }
+        llvm_unreachable("unknown node kind");
+    }
+};
+
+
+/* the text of a tree, appended to out */
+class PrintVisitor final : public Visitor<PrintVisitor, void> {
+    string& out;
+
+public:
+    explicit PrintVisitor(string& o) : out(o) {}
+
+    void visitInteger(const IntegerAST&);
+    void visitName(const NameAST&);
+    void visitBinary(const BinaryInstrAST&);
+    void visitCall(const CallInstrAST&);
+    void visitAssign(const AssignInstrAST&);
+    void visitPrototype(const PrototypeAST&);
+    void visitReturn(const ReturnAST&);
+    void visitIf(const IfAST&);
+    void visitWhile(const WhileAST&);
+    void visitFunction(const FunctionAST&);
+
+private:
+    void visitBody(const Statements&);
+};
+
+
+/* the nodes of a tree, in total and by kind */
+class CountVisitor final : public Visitor<CountVisitor, size_t> {
+    static const size_t KINDS = static_cast<size_t>(NodeKind::FUNCTION) + 1;
+    size_t kinds[KINDS] = {};
+
+public:
+    /* nodes of the kind over every tree visited so far */
+    size_t getCount(const NodeKind kind) const {
+        return kinds[static_cast<size_t>(kind)];
+    }
+
+    size_t visitInteger(const IntegerAST& node) { return count(node); }
+    size_t visitName(const NameAST& node) { return count(node); }
+    size_t visitBinary(const BinaryInstrAST& node) {
+        return count(node) + visit(*node.getLeft()) + visit(*node.getRight());
+    }
+    size_t visitCall(const CallInstrAST& node) {
+        size_t nodes = count(node);
+        for (const BaseAST* argument: node.getArguments())
+            nodes += visit(*argument);
+        return nodes;
+    }
+    size_t visitAssign(const AssignInstrAST& node) {
+        return count(node) + visit(*node.getValue());
+    }
+    size_t visitPrototype(const PrototypeAST& node) { return count(node); }
+    size_t visitReturn(const ReturnAST& node) {
+        return count(node) + visit(*node.getValue());
+    }
+    size_t visitIf(const IfAST& node) {
+        return count(node) + visit(*node.getCondition()) +
+            visitBody(node.getBody()) + visitBody(node.getElse());
+    }
+    size_t visitWhile(const WhileAST& node) {
+        return count(node) + visit(*node.getCondition()) +
+            visitBody(node.getBody());
+    }
+    size_t visitFunction(const FunctionAST& node) {
+        return count(node) + visit(*node.getPrototype()) +
+            visitBody(node.getBody());
+    }
+
+private:
+    size_t visitBody(const Statements& statements) {
+        size_t nodes = 0;
+        for (const BaseAST* statement: statements)
+            nodes += visit(*statement);
+        return nodes;
+    }
+    size_t count(const BaseAST& node) {
+        ++kinds[static_cast<size_t>(node.getKind())];
+        return 1;
+    }
+};
+
+
+/*
+ * IR of a tree through the IRBuilder of a session. Code goes where the
+ * builder is and the builder moves on as control flow makes new blocks, so
+ * statements visited in turn continue where the last one ended. Functions
+ * go to the module of the insertion block, or to the one of the session.
+ * Values are 32 bit integers, a condition is true when not 0, x / 0 is 0
+ * and INT_MIN / -1 wraps to INT_MIN. nullptr means a name nobody assigned,
+ * an unknown function, a function that did not verify and was erased
+ * again, or no insertion block.
+ */
+class CodegenVisitor final : public Visitor<CodegenVisitor, llvm::Value*> {
+    Session& session;
+    llvm::IRBuilder<>& builder;
+
+public:
+    /* the builder of the session, from where it is */
+    explicit CodegenVisitor(Session&);
+
+    llvm::Value* visitInteger(const IntegerAST&);
+    llvm::Value* visitName(const NameAST&);
+    llvm::Value* visitBinary(const BinaryInstrAST&);
+    llvm::Value* visitCall(const CallInstrAST&);
+    llvm::Value* visitAssign(const AssignInstrAST&);
+    llvm::Value* visitPrototype(const PrototypeAST&);
+    llvm::Value* visitReturn(const ReturnAST&);
+    llvm::Value* visitIf(const IfAST&);
+    llvm::Value* visitWhile(const WhileAST&);
+    llvm::Value* visitFunction(const FunctionAST&);
+
+    /* the visits of the expression kinds with the children generated */
+    llvm::Value* integer(const int value);
+    llvm::Value* load(Symbol name);
+    llvm::Value* binary(OpCode, llvm::Value* left, llvm::Value* right);
+    /* the function a call of `count` arguments goes to, nullptr for none */
+    llvm::Function* callee(Symbol name, const size_t count) const;
+    llvm::Value* call(llvm::Function*, llvm::ArrayRef<llvm::Value*>);
+    llvm::Value* store(Symbol name, llvm::Value* value);
+
+private:
+    Block* place() const { return builder.GetInsertBlock(); }
+    llvm::Module* getModule() const;
+    llvm::Value* slot(Symbol name, const bool make);
+    llvm::Value* divide(llvm::Value* left, llvm::Value* right);
+    /* false if a statement gave nothing, the rest after a return is dead */
+    bool visitBody(const Statements&);
+    llvm::Value* condition(const BaseAST&);
+    bool terminated() const;
+};
+
+
+/* whether the module is valid IR, what the verifier found in errors if not */
+bool verify(const llvm::Module&, string* errors=nullptr);
@@ -7,6 +7,7 @@ using namespace std;
 
 #include "../src/ast.hpp"
 #include "../src/lexer.hpp"
+#include "../src/unit.hpp"
 
 
 bool operator == (const BaseAST& left, const BaseAST& right) {
@@ -16,10 +17,9 @@ bool operator != (const BaseAST& left, const BaseAST& right) {
     return !(left.str() == right.str());
 }
 
-static Lexer lexer;
-
-
 TEST_CASE("Test IntegerAST") {
-    auto lexem = lexer.tokenize("45")[0];
-    REQUIRE(IntegerAST(std::atoi(lexem.getContent().c_str())) == IntegerAST(45));
+    CompilationUnit unit("45");
+    auto lexem = unit.getLexems()[0];
+    REQUIRE(IntegerAST(std::atoi(lexem.getContent().str().c_str())) ==
+        IntegerAST(45));
 }
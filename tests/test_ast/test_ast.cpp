@@ -1,6 +1,7 @@
 #include <llvm/IR/ValueSymbolTable.h>
 #include <llvm/IR/Type.h>
 #include <llvm/IR/Instructions.h>
+#include <llvm/IR/Verifier.h>
 
 #include <llvm/ADT/SmallVector.h>
 
@@ -27,7 +28,7 @@ std::ostream& operator << (std::ostream& os, const BaseAST& ast) {
 void AST_Test::testIntegerAST() {
     IntegerAST ast(45);
     ASSERT(ast == IntegerAST(
-        std::atoi(Lexer().tokenize("45")[0].getContent().c_str())
+        std::atoi(Lexer().tokenize("45")[0].getContent().str().c_str())
     ));
 }
 
@@ -47,35 +48,147 @@ void AST_Test::testNameAST() {
     auto* testBlock = llvm::BasicBlock::Create(
         testContext, "test", testFunction
     );
-    auto* allocate = new llvm::AllocaInst(IntegerType, 4, "name", testBlock);
-    auto* store = new llvm::StoreInst(
-        llvm::ConstantInt::get(IntegerType, 2345), allocate, testBlock
-    );
-    llvm::Value* load = NameAST("name", testBlock).codegen();
-    if (load == nullptr)
-        return;
-    llvm::ReturnInst::Create(testContext, load, testBlock);
-    testFunction->print(llvm::outs());
-    cout << endl;
+    session.getBuilder().SetInsertPoint(testBlock);
+    CodegenVisitor visitor(session);
+    ASSERT(visitor.visit(
+        AssignInstrAST("name", new IntegerAST(2345))) != nullptr);
+    llvm::Value* load = visitor.visit(NameAST("name"));
+    ASSERT(load != nullptr && llvm::isa<llvm::LoadInst>(load));
+    /* the slots are the session's, any visitor of it finds them */
+    load = CodegenVisitor(session).visit(NameAST("name"));
+    ASSERT(load != nullptr && llvm::isa<llvm::LoadInst>(load));
+    auto* temporary = new llvm::FreezeInst(load, "temporary", testBlock);
+    llvm::ReturnInst::Create(testContext, temporary, testBlock);
+    ASSERT(!llvm::verifyFunction(*testFunction, &llvm::errs()));
+
+    /* arguments are values, not slots to load from */
+    testFunction->getArg(0)->setName("a");
+    ASSERT(CodegenVisitor(session).visit(NameAST("a")) ==
+        testFunction->getArg(0));
+    ASSERT(CodegenVisitor(session).visit(NameAST("nobody")) == nullptr);
+    /* neither are the values the IR names itself */
+    ASSERT(CodegenVisitor(session).visit(NameAST("temporary")) == nullptr);
+    ASSERT(CodegenVisitor(session).visit(NameAST("test")) == nullptr);
+
+    /* code goes where the builder is, nowhere without an insertion block */
+    session.getBuilder().ClearInsertionPoint();
+    ASSERT(CodegenVisitor(session).visit(NameAST("name")) == nullptr);
 }
 
 void AST_Test::testBinaryInstrAST() {
     llvm::Function* testFunction = makeLLVMFunction(IntegerType,
-        "testBinaryInstrAST", Args{IntegerType, IntegerType, IntegerType});
+        "testBinaryInstrAST", Args{IntegerType, IntegerType});
     auto* testBlock = llvm::BasicBlock::Create(
         testContext, "entry", testFunction);
-    llvm::ReturnInst::Create(
-        testContext, llvm::ConstantInt::get(IntegerType, 34), testBlock);
-    testFunction->print(llvm::outs());
-    cout << endl;
+    testFunction->getArg(0)->setName("a");
+    testFunction->getArg(1)->setName("b");
+
+    /* (a - 3) * b / 2 == a + 1 */
+    const BinaryInstrAST tree(OpCode::EQ,
+        new BinaryInstrAST(OpCode::DIV,
+            new BinaryInstrAST(OpCode::MUL,
+                new BinaryInstrAST(OpCode::SUB, new NameAST("a"),
+                    new IntegerAST(3)),
+                new NameAST("b")),
+            new IntegerAST(2)),
+        new BinaryInstrAST(OpCode::ADD, new NameAST("a"), new IntegerAST(1)));
+    session.getBuilder().SetInsertPoint(testBlock);
+    llvm::Value* result = CodegenVisitor(session).visit(tree);
+    ASSERT(result != nullptr && result->getType() == IntegerType);
+    llvm::ReturnInst::Create(testContext, result, testBlock);
+    ASSERT(!llvm::verifyFunction(*testFunction, &llvm::errs()));
+
+    size_t operators = 0;
+    for (const llvm::Instruction& instruction: *testBlock)
+        operators += instruction.isBinaryOp() ||
+            llvm::isa<llvm::ICmpInst>(instruction);
+    ASSERT(operators == 5);
 }
 
 void AST_Test::testCallInstrAST() {
-    //ASSERT(false);
+    llvm::Function* callee = makeLLVMFunction(IntegerType, "callee",
+        Args{IntegerType, IntegerType});
+    llvm::Function* testFunction = makeLLVMFunction(IntegerType,
+        "testCallInstrAST");
+    auto* testBlock = llvm::BasicBlock::Create(
+        testContext, "entry", testFunction);
+
+    session.getBuilder().SetInsertPoint(testBlock);
+    CodegenVisitor visitor(session);
+    llvm::Value* call = visitor.visit(CallInstrAST(intern("callee"),
+        {new IntegerAST(1), new IntegerAST(2)}));
+    ASSERT(call != nullptr);
+    ASSERT(llvm::cast<llvm::CallInst>(call)->getCalledFunction() == callee);
+    llvm::ReturnInst::Create(testContext, call, testBlock);
+    ASSERT(!llvm::verifyFunction(*testFunction, &llvm::errs()));
+
+    /* unknown functions and wrong argument counts give nothing */
+    ASSERT(visitor.visit(CallInstrAST(intern("unknown"), {})) == nullptr);
+    ASSERT(visitor.visit(CallInstrAST(intern("callee"),
+        {new IntegerAST(1)})) == nullptr);
 }
 
 void AST_Test::testAssignInstrAST() {
-    //ASSERT(false);
+    llvm::Function* testFunction = makeLLVMFunction(IntegerType,
+        "testAssignInstrAST");
+    auto* testBlock = llvm::BasicBlock::Create(
+        testContext, "entry", testFunction);
+
+    /* x = 1, x = x + 2 share one slot */
+    session.getBuilder().SetInsertPoint(testBlock);
+    CodegenVisitor visitor(session);
+    ASSERT(visitor.visit(AssignInstrAST(intern("x"), new IntegerAST(1))) !=
+        nullptr);
+    ASSERT(visitor.visit(AssignInstrAST(intern("x"), new BinaryInstrAST(
+        OpCode::ADD, new NameAST("x"), new IntegerAST(2)))) != nullptr);
+    llvm::Value* x = visitor.visit(NameAST("x"));
+    ASSERT(x != nullptr);
+    llvm::ReturnInst::Create(testContext, x, testBlock);
+    ASSERT(!llvm::verifyFunction(*testFunction, &llvm::errs()));
+
+    size_t slots = 0;
+    for (const llvm::Instruction& instruction: *testBlock)
+        if (const auto* alloca = llvm::dyn_cast<llvm::AllocaInst>(&instruction))
+            slots += alloca->getType()->getAddressSpace() == 0;
+    ASSERT(slots == 1);
+    ASSERT(llvm::isa<llvm::AllocaInst>(testBlock->front()));
+}
+
+
+void AST_Test::testVisitor() {
+    /* res = add(2 * x, f()) == 3 */
+    AssignInstrAST tree("res", new BinaryInstrAST("==",
+        new CallInstrAST("add", {
+            new BinaryInstrAST("*", new IntegerAST(2), new NameAST("x")),
+            new CallInstrAST("f", {})
+        }),
+        new IntegerAST(3)));
+    ASSERT(tree.getKind() == NodeKind::ASSIGN);
+
+    CountVisitor counter;
+    ASSERT(counter.visit(tree) == 8);
+    ASSERT(counter.getCount(NodeKind::INTEGER) == 2);
+    ASSERT(counter.getCount(NodeKind::NAME) == 1);
+    ASSERT(counter.getCount(NodeKind::BINARY) == 2);
+    ASSERT(counter.getCount(NodeKind::CALL) == 2);
+    ASSERT(counter.getCount(NodeKind::ASSIGN) == 1);
+
+    string out = "> ";
+    PrintVisitor(out).visit(tree);
+    ASSERT(out == "> " + tree.str());
+    ASSERT(tree.str() == "[AssignInstrAST: res = [BinaryInstrAST: == "
+        "[CallInstrAST: 'add' ([BinaryInstrAST: * [IntegerAST: 2] "
+        "[Name: x of [IntegerType]]], [CallInstrAST: 'f' ()])] "
+        "[IntegerAST: 3]]]");
+
+    const PrototypeAST prototype("add", {"a", "b"});
+    ASSERT(prototype.getKind() == NodeKind::PROTOTYPE);
+    ASSERT(prototype.str() == "[PrototypeAST: 'add' (a, b)]");
+    auto* function = llvm::dyn_cast_or_null<llvm::Function>(
+        CodegenVisitor(session).visit(prototype));
+    ASSERT(function != nullptr && function->arg_size() == 2);
+    ASSERT(function->getName() == "add" && function->isDeclaration());
+    ASSERT(CodegenVisitor(session).visit(prototype) == function);
 }
 
 
@@ -88,6 +201,7 @@ TestSuite* AST_Test::suite() {
         Pair("testBinaryAST", &AST_Test::testBinaryInstrAST),
         Pair("testCallIntrAST", &AST_Test::testCallInstrAST),
         Pair("testAssignInstrAST", &AST_Test::testAssignInstrAST),
+        Pair("testVisitor", &AST_Test::testVisitor),
     };
     for (const Pair& test: cases) {
         suite->addTest(new TestCaller<AST_Test>(test.first, test.second));
@@ -5,6 +5,7 @@
 
 #include "../src/lexer.hpp"
 #include "../src/ast.hpp"
+#include "../src/visitor.hpp"
 
 #include <CppUnitCommon.hpp>
 using std::endl;
@@ -16,8 +17,9 @@ namespace ASTTest {
 using Args = std::vector<llvm::Type*>;
 
 class AST_Test final : public TestCase {
-    llvm::LLVMContext testContext;
-    llvm::Module testModule;
+    Session session;
+    llvm::LLVMContext& testContext;
+    llvm::Module& testModule;
     Lexer lexer;
 
     llvm::Type* VoidType;
@@ -25,7 +27,8 @@ class AST_Test final : public TestCase {
 
 
 public:
-    AST_Test() : TestCase(), testModule("AST_TestModule", testContext) {
+    AST_Test() : TestCase(), session("AST_TestModule")
+        , testContext(session.getContext()), testModule(session.getModule()) {
         VoidType = llvm::Type::getVoidTy(testContext);
         IntegerType = llvm::IntegerType::get(testContext, 32);
     }
@@ -36,6 +39,7 @@ public:
     void testBinaryInstrAST();
     void testCallInstrAST();
     void testAssignInstrAST();
+    void testVisitor();
 
     static TestSuite* suite();
 
@@ -0,0 +1,491 @@
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <regex>
+#include <sstream>
+#include <thread>
+
+#include "test_lexer.hpp"
+using namespace LexerTest;
+
+
+void Lexer_Test::testKeywords() {
+    for (const char* keyword: KEYWORDS)
+        ASSERT(classifyWord(keyword) == Tag::KEYWORD);
+    for (const char* name: {"iffy", "defines", "els", "x", "While", "_if"})
+        ASSERT(classifyWord(name) == Tag::NAME);
+
+    const string program = "if iffy else_ else";
+    const vector<Lexem> lexems = lexer.tokenize(program);
+    ASSERT(lexems.size() == 4);
+    ASSERT(lexems[0].getTag() == Tag::KEYWORD);
+    ASSERT(lexems[1].getTag() == Tag::NAME);
+    ASSERT(lexems[2].getTag() == Tag::NAME);
+    ASSERT(lexems[3].getTag() == Tag::KEYWORD);
+
+    /* a keyword with more word characters around it is one whole name */
+    const string affixed = "defined ifx return_ while1 xif _define 2while";
+    const vector<Lexem> words = lexer.tokenize(affixed);
+    const vector<string> names = {
+        "defined", "ifx", "return_", "while1", "xif", "_define"
+    };
+    ASSERT(words.size() == names.size() + 2);
+    for (size_t i = 0; i < names.size(); ++i) {
+        ASSERT(words[i].getTag() == Tag::NAME);
+        ASSERT(words[i].getContent() == names[i]);
+        ASSERT(words[i].getSymbol() == intern(names[i]));
+    }
+    ASSERT(words[6].getTag() == Tag::INTEGER && words[6].getContent() == "2");
+    ASSERT(words[7].getTag() == Tag::KEYWORD &&
+        words[7].getContent() == "while");
+}
+
+void Lexer_Test::testOperators() {
+    const string program = "a == b = c + d / e";
+    const vector<Lexem> lexems = lexer.tokenize(program);
+    const vector<Tag> expected = {
+        Tag::NAME, Tag::OPERATOR, Tag::NAME, Tag::ASSIGN, Tag::NAME,
+        Tag::OPERATOR, Tag::NAME, Tag::OPERATOR, Tag::NAME,
+    };
+    ASSERT(lexems.size() == expected.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+        ASSERT(lexems[i].getTag() == expected[i]);
+    ASSERT(lexems[1].getContent() == "==");
+}
+
+void Lexer_Test::testIndent() {
+    const string program =
+        "if a:\n    while b:\n         c = 1\n  \n\n    d()\ne    =  2\n"
+        "            f\n";
+    const vector<Lexem> lexems = lexer.tokenize(program);
+    const vector<Tag> expected = {
+        Tag::KEYWORD, Tag::NAME, Tag::COLON, Tag::EOL,
+        Tag::INDENT, Tag::KEYWORD, Tag::NAME, Tag::COLON, Tag::EOL,
+        Tag::INDENT, Tag::NAME, Tag::ASSIGN, Tag::INTEGER, Tag::EOL,
+        Tag::EOL, Tag::EOL,
+        Tag::DEDENT, Tag::NAME, Tag::LEFT_BRACKET, Tag::RIGHT_BRACKET,
+        Tag::EOL,
+        Tag::DEDENT, Tag::NAME, Tag::ASSIGN, Tag::INTEGER, Tag::EOL,
+        Tag::INDENT, Tag::INDENT, Tag::INDENT, Tag::NAME, Tag::EOL,
+        Tag::DEDENT, Tag::DEDENT, Tag::DEDENT,
+    };
+    ASSERT(lexems.size() == expected.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+        ASSERT(lexems[i].getTag() == expected[i]);
+
+    /* an INDENT spans the spaces of its level, a DEDENT is empty */
+    ASSERT(lexems[9].getStart() == program.find("     c"));
+    ASSERT(lexems[9].getContent() == "    ");
+    ASSERT(lexems[16].getStart() == program.find("d()"));
+    ASSERT(lexems[16].getContent().empty());
+    ASSERT(lexems[28].getStart() == program.find("    f"));
+    ASSERT(lexems.back().getStart() == program.size());
+
+    /* the lexems of a line do not depend on how deep it is */
+    ASSERT(lexer.tokenize("a    =    b").size() == 3);
+}
+
+void Lexer_Test::testParallel() {
+    string program;
+    for (int i = 0; i < 200; ++i)
+        program += "define f" + std::to_string(i) + "(a, b):\n"
+            "        return a == b\n\n";
+    const vector<Lexem> expected = lexer.tokenize(program);
+
+    llvm::ThreadPool pool(llvm::hardware_concurrency(4));
+    for (const size_t chunk: {1, 7, 64, 4096, 1 << 20}) {
+        const vector<Lexem> actual = lexer.tokenize(program, pool, chunk);
+        ASSERT(actual.size() == expected.size());
+        for (size_t i = 0; i < actual.size(); ++i) {
+            ASSERT(actual[i].getTag() == expected[i].getTag());
+            ASSERT(actual[i].getStart() == expected[i].getStart());
+            ASSERT(actual[i].getLength() == expected[i].getLength());
+        }
+    }
+
+    const string invalid = program + "x = $\n" + program;
+    bool thrown = false;
+    try {
+        lexer.tokenize(invalid, pool, 64);
+    } catch (const SyntaxError&) {
+        thrown = true;
+    }
+    ASSERT(thrown);
+}
+
+void Lexer_Test::testSymbols() {
+    const string program = "alpha = beta(alpha, 1)\nbeta = alpha\n";
+    const vector<Lexem> lexems = lexer.tokenize(program);
+    const Symbol alpha = lexems[0].getSymbol();
+    const Symbol beta = lexems[2].getSymbol();
+
+    ASSERT(!alpha.isEmpty() && !beta.isEmpty() && alpha != beta);
+    ASSERT(lexems[4].getSymbol() == alpha);
+    ASSERT(lexems[9].getSymbol() == beta);
+    ASSERT(lexems[11].getSymbol() == alpha);
+    ASSERT(lexems[1].getSymbol().isEmpty());
+    ASSERT(alpha.str() == "alpha" && beta.str() == "beta");
+    ASSERT(intern("alpha") == alpha);
+
+    llvm::ThreadPool pool(llvm::hardware_concurrency(4));
+    string large;
+    for (int i = 0; i < 500; ++i)
+        large += "name" + std::to_string(i % 50) + " = alpha\n";
+    const vector<Lexem> parallel = lexer.tokenize(large, pool, 16);
+    for (const Lexem& lexem: parallel)
+        if (lexem.getTag() == Tag::NAME)
+            ASSERT(lexem.getSymbol() == intern(lexem.getContent()));
+}
+
+void Lexer_Test::testColumns() {
+    const string program = "if f(a, (b + c) * g()):\n    x = h((1), 2)\n"
+        "y = 3\n";
+    const vector<Lexem> lexems = lexer.tokenize(program);
+    TokenBuffer tokens;
+    lexer.tokenize(program, tokens);
+    ASSERT(tokens.size() == lexems.size());
+    ASSERT(tokens.getBytes() < lexems.capacity() * sizeof(Lexem));
+    const vector<Lexem> back = tokens.toLexems();
+    for (size_t i = 0; i < lexems.size(); ++i) {
+        ASSERT(back[i].getTag() == lexems[i].getTag());
+        ASSERT(back[i].getStart() == lexems[i].getStart());
+        ASSERT(back[i].getContent() == lexems[i].getContent());
+        ASSERT(back[i].getSymbol() == lexems[i].getSymbol());
+    }
+
+    /* the scans against a walk over the lexems */
+    for (size_t i = 0; i < lexems.size(); ++i) {
+        size_t eol = i;
+        while (eol < lexems.size() && lexems[eol].getTag() != Tag::EOL)
+            ++eol;
+        ASSERT(tokens.lineEnd(i) == eol);
+    }
+    ASSERT(tokens.find(Tag::COLON) == 15);
+    ASSERT(tokens.find(Tag::COLON, 16) == tokens.size());
+    ASSERT(tokens.lineEnd(tokens.size()) == tokens.size());
+}
+
+TestSuite* Lexer_Test::suite() {
+    using Pair = Pair<Lexer_Test>;
+    auto* suite = new TestSuite;
+    vector<Pair> cases = {
+        Pair("testKeywords", &Lexer_Test::testKeywords),
+        Pair("testOperators", &Lexer_Test::testOperators),
+        Pair("testIndent", &Lexer_Test::testIndent),
+        Pair("testParallel", &Lexer_Test::testParallel),
+        Pair("testSymbols", &Lexer_Test::testSymbols),
+        Pair("testColumns", &Lexer_Test::testColumns),
+    };
+    for (const Pair& test: cases) {
+        suite->addTest(new TestCaller<Lexer_Test>(test.first, test.second));
+    }
+    return suite;
+}
+
+
+bool LexemStream_Test::same(const Lexem& left, const Lexem& right) const {
+    return left.getTag() == right.getTag() &&
+        left.getStart() == right.getStart() &&
+        left.getContent() == right.getContent();
+}
+
+void LexemStream_Test::testChunked() {
+    for (const string& program: programs) {
+        const vector<Lexem> expected = lexer.tokenize(program);
+        /* every chunk size cuts some lexem in two */
+        for (size_t chunk = 1; chunk <= 8; ++chunk) {
+            std::istringstream input(program);
+            LexemStream stream(input, lexer, chunk);
+            size_t count = 0;
+            Lexem lexem;
+            while (stream.next(lexem)) {
+                ASSERT(count < expected.size());
+                ASSERT(same(lexem, expected[count++]));
+            }
+            ASSERT(count == expected.size());
+        }
+    }
+}
+
+void LexemStream_Test::testLines() {
+    for (const string& program: programs) {
+        const vector<Lexem> expected = lexer.tokenize(program);
+        std::istringstream input(program);
+        LexemStream stream(input, lexer, 3);
+        size_t count = 0;
+        vector<Lexem> line;
+        while (stream.nextLine(line)) {
+            ASSERT(line.back().getTag() == Tag::EOL ||
+                stream.getPosition() == program.size());
+            for (const Lexem& lexem: line) {
+                ASSERT(count < expected.size());
+                ASSERT(same(lexem, expected[count++]));
+            }
+        }
+        ASSERT(count == expected.size());
+    }
+}
+
+void LexemStream_Test::testMapped() {
+    for (const string& program: programs) {
+        const vector<Lexem> expected = lexer.tokenize(program);
+        LexemStream stream(llvm::MemoryBuffer::getMemBuffer(program), lexer);
+        size_t count = 0;
+        Lexem lexem;
+        while (stream.next(lexem)) {
+            ASSERT(count < expected.size());
+            ASSERT(same(lexem, expected[count++]));
+        }
+        ASSERT(count == expected.size());
+    }
+}
+
+void LexemStream_Test::testSyntaxError() {
+    std::istringstream input("name = 4 $ 5\n");
+    LexemStream stream(input, lexer, 2);
+    vector<Lexem> line;
+    bool thrown = false;
+    try {
+        stream.nextLine(line);
+    } catch (const SyntaxError&) {
+        thrown = true;
+    }
+    ASSERT(thrown);
+}
+
+
+TestSuite* LexemStream_Test::suite() {
+    using Pair = Pair<LexemStream_Test>;
+    auto* suite = new TestSuite;
+    vector<Pair> cases = {
+        Pair("testChunked", &LexemStream_Test::testChunked),
+        Pair("testLines", &LexemStream_Test::testLines),
+        Pair("testMapped", &LexemStream_Test::testMapped),
+        Pair("testSyntaxError", &LexemStream_Test::testSyntaxError),
+    };
+    for (const Pair& test: cases) {
+        suite->addTest(
+            new TestCaller<LexemStream_Test>(test.first, test.second)
+        );
+    }
+    return suite;
+}
+
+
+
+void Automaton_Test::testMatch() {
+    const Automaton automaton({"if", "\\w+", "=", "==", "\\d+", "a{2,3}b?"});
+    struct Case {
+        string input;
+        unsigned int rule;
+        unsigned int length;
+    };
+    const vector<Case> cases = {
+        /* the longest match of a rule, not its first */
+        {"while(", 1, 5},
+        {"x_1 = 2", 1, 3},
+        /* the first rule wins a tie */
+        {"if", 0, 2},
+        {"if(", 0, 2},
+        {"123", 1, 3},
+        {"aab", 1, 3},
+        /* and against a later rule with a longer match */
+        {"iffy", 0, 2},
+        {"==", 2, 1},
+        {"=x", 2, 1},
+        /* no rule matches */
+        {"(", Automaton::NO_RULE, 0},
+        {"", Automaton::NO_RULE, 0},
+        {" if", Automaton::NO_RULE, 0},
+    };
+    for (const Case& c: cases) {
+        const Automaton::Match found = automaton.match(
+            c.input.data(), c.input.data() + c.input.size());
+        ASSERT(found.rule == c.rule);
+        ASSERT(found.length == c.length);
+        ASSERT(found.isEmpty() == (c.rule == Automaton::NO_RULE));
+    }
+
+    /* the end of the input cuts a match that could go on */
+    const string text = "whi";
+    ASSERT(automaton.match(text.data(), text.data() + 3).partial);
+    ASSERT(!automaton.match(text.data(), text.data() + 3).isEmpty());
+    const Automaton literal({"==", "="});
+    ASSERT(literal.match(text.data(), text.data()).partial);
+    const string equal = "=";
+    const Automaton::Match cut = literal.match(equal.data(), equal.data() + 1);
+    ASSERT(cut.rule == 1 && cut.length == 1 && cut.partial);
+}
+
+void Automaton_Test::testRegex() {
+    /*
+     * The automaton against std::regex, which tries each rule in turn: the
+     * first rule to match any prefix is taken, with the longest prefix it
+     * matches.
+     */
+    const vector<string> patterns = {
+        "[ ]+", "\\d+", "\\n", "ab|ba", "a(b|c)*d?", "\\w+", "x{2,4}",
+        "[^a-z0-9 \\n]", "(ab)+", "\\+\\+?", "==", "=",
+    };
+    const Automaton automaton(patterns);
+    vector<std::regex> rules;
+    for (const string& pattern: patterns)
+        rules.emplace_back(pattern);
+
+    const string alphabet = "abcdx01 _\n+=(";
+    std::mt19937 random(7);
+    for (size_t i = 0; i < 3000; ++i) {
+        string input;
+        for (size_t length = random() % 12; input.size() < length; )
+            input += alphabet[random() % alphabet.size()];
+
+        unsigned int rule = Automaton::NO_RULE, length = 0;
+        for (unsigned int r = 0;
+                r < rules.size() && rule == Automaton::NO_RULE; ++r) {
+            for (size_t n = input.size() + 1; n-- > 0; ) {
+                if (std::regex_match(input.begin(), input.begin() + n,
+                        rules[r])) {
+                    rule = r;
+                    length = n;
+                    break;
+                }
+            }
+        }
+        const Automaton::Match found = automaton.match(
+            input.data(), input.data() + input.size());
+        ASSERT(found.rule == rule);
+        ASSERT(found.length == length);
+    }
+}
+
+TestSuite* Automaton_Test::suite() {
+    using Pair = Pair<Automaton_Test>;
+    auto* suite = new TestSuite;
+    vector<Pair> cases = {
+        Pair("testMatch", &Automaton_Test::testMatch),
+        Pair("testRegex", &Automaton_Test::testRegex),
+    };
+    for (const Pair& test: cases) {
+        suite->addTest(
+            new TestCaller<Automaton_Test>(test.first, test.second));
+    }
+    return suite;
+}
+
+
+
+string Scan_Test::randomText(const size_t size) const {
+    /* long runs of each class with every kind of byte in between */
+    const string alphabet = "aZ_09    (\n=\x80\xff@[`{/:";
+    std::mt19937 random(42);
+    string text;
+    while (text.size() < size) {
+        const char c = alphabet[random() % alphabet.size()];
+        text.append(random() % 40 + 1, c);
+    }
+    return text;
+}
+
+void Scan_Test::testSpan() {
+    const string text = randomText(1 << 14);
+    const Isa best = detectIsa();
+    for (const CharClass cls:
+            {CharClass::DIGIT, CharClass::WORD, CharClass::SPACE}) {
+        for (size_t start = 0; start < text.size(); start += 7) {
+            const char* begin = text.data() + start;
+            const char* end = text.data() + text.size();
+            useIsa(Isa::SCALAR);
+            const size_t expected = span(cls, begin, end);
+            for (const Isa isa: {Isa::SSE2, Isa::AVX2}) {
+                if (!useIsa(isa)) continue;
+                ASSERT(span(cls, begin, end) == expected);
+            }
+        }
+    }
+    useIsa(best);
+}
+
+void Scan_Test::testTokenize() {
+    const string text = "define function_with_a_rather_long_name(a, b):\n"
+        "                        return 123456789012345678901234567890\n";
+    const Isa best = detectIsa();
+    useIsa(Isa::SCALAR);
+    const vector<Lexem> expected = lexer.tokenize(text);
+    for (const Isa isa: {Isa::SSE2, Isa::AVX2}) {
+        if (!useIsa(isa)) continue;
+        const vector<Lexem> actual = lexer.tokenize(text);
+        ASSERT(actual.size() == expected.size());
+        for (size_t i = 0; i < actual.size(); ++i) {
+            ASSERT(actual[i].getTag() == expected[i].getTag());
+            ASSERT(actual[i].getContent() == expected[i].getContent());
+        }
+    }
+    useIsa(best);
+}
+
+void Scan_Test::testFindTag() {
+    const vector<Lexem> lexems = lexer.tokenize(
+        "f(a, (b + c) * g())\nx = h((1), 2)\n" + string(100, ' ') +
+        "y = (3)\n");
+    vector<Tag> tags;
+    for (size_t i = 0; i < 40; ++i)
+        for (const Lexem& lexem: lexems) tags.push_back(lexem.getTag());
+
+    const Isa best = detectIsa();
+    for (const Tag a: {Tag::EOL, Tag::LEFT_BRACKET, Tag::UNKNOWN}) {
+        for (size_t start = 0; start <= tags.size(); start += 3) {
+            const Tag* begin = tags.data() + start;
+            const Tag* end = tags.data() + tags.size();
+            useIsa(Isa::SCALAR);
+            const size_t expected = findTag(a, Tag::RIGHT_BRACKET, begin, end);
+            for (const Isa isa: {Isa::SSE2, Isa::AVX2}) {
+                if (!useIsa(isa)) continue;
+                ASSERT(findTag(a, Tag::RIGHT_BRACKET, begin, end) == expected);
+                ASSERT(findTag(a, a, begin, end) ==
+                    size_t(std::find(begin, end, a) - begin));
+            }
+        }
+    }
+    useIsa(best);
+}
+
+void Scan_Test::testSwitch() {
+    string program;
+    for (int i = 0; i < 2000; ++i)
+        program += "define name" + std::to_string(i) + "(a, b):\n"
+            "    return 1234567 + a\n";
+    const vector<Lexem> expected = lexer.tokenize(program);
+
+    /* the implementation changes under a parallel lex */
+    const Isa best = detectIsa();
+    llvm::ThreadPool pool(llvm::hardware_concurrency(4));
+    std::atomic<bool> done(false);
+    std::thread switching([&] {
+        for (size_t i = 0; !done; ++i)
+            useIsa(static_cast<Isa>(i % 3));
+    });
+    for (size_t i = 0; i < 4; ++i) {
+        const vector<Lexem> actual = lexer.tokenize(program, pool, 256);
+        ASSERT(actual.size() == expected.size());
+        for (size_t j = 0; j < actual.size(); ++j)
+            ASSERT(actual[j].getLength() == expected[j].getLength());
+    }
+    done = true;
+    switching.join();
+    useIsa(best);
+}
+
+TestSuite* Scan_Test::suite() {
+    using Pair = Pair<Scan_Test>;
+    auto* suite = new TestSuite;
+    vector<Pair> cases = {
+        Pair("testSpan", &Scan_Test::testSpan),
+        Pair("testTokenize", &Scan_Test::testTokenize),
+        Pair("testFindTag", &Scan_Test::testFindTag),
+        Pair("testSwitch", &Scan_Test::testSwitch),
+    };
+    for (const Pair& test: cases) {
+        suite->addTest(new TestCaller<Scan_Test>(test.first, test.second));
+    }
+    return suite;
+}
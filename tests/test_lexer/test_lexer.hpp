@@ -0,0 +1,88 @@
+#pragma once
+
+#include "../../src/automaton.hpp"
+#include "../../src/lexer.hpp"
+#include "../../src/stream.hpp"
+#include "../../src/scan.hpp"
+#include "../../src/tokens.hpp"
+
+#include <CppUnitCommon.hpp>
+
+
+namespace LexerTest {
+
+class Lexer_Test final : public TestCase {
+    Lexer lexer;
+
+public:
+    void testKeywords();
+    void testOperators();
+    void testIndent();
+    void testParallel();
+    void testSymbols();
+    void testColumns();
+
+    static TestSuite* suite();
+};
+
+
+class LexemStream_Test final : public TestCase {
+    Lexer lexer;
+
+    const vector<string> programs = {
+        "",
+        "variable = 56\n",
+        "define add(a, b):\n    return a + b\n",
+        "res = 2 + add(45, variable)\nwhile x == 10:\n        x = x - 1",
+        "call(nested(45 / 3), name, void())   \n\n  tail_name_1234567",
+        "if a:\n    while b:\n         c = 1\n  \n\n    d()\ne = 2\n    f",
+    };
+
+public:
+    void testChunked();
+    void testLines();
+    void testMapped();
+    void testSyntaxError();
+
+    static TestSuite* suite();
+
+private:
+    bool same(const Lexem&, const Lexem&) const;
+};
+
+
+class Automaton_Test final : public TestCase {
+public:
+    void testMatch();
+    void testRegex();
+
+    static TestSuite* suite();
+};
+
+
+class Scan_Test final : public TestCase {
+    Lexer lexer;
+
+public:
+    void testSpan();
+    void testTokenize();
+    void testFindTag();
+    void testSwitch();
+
+    static TestSuite* suite();
+
+private:
+    string randomText(const size_t size) const;
+};
+
+
+void run() {
+    std::cout << __PRETTY_FUNCTION__ << std::endl;
+    TestRunner runner;
+    runner.addTest(Lexer_Test::suite());
+    runner.addTest(LexemStream_Test::suite());
+    runner.addTest(Automaton_Test::suite());
+    runner.addTest(Scan_Test::suite());
+    runner.run();
+}
+}
@@ -4,6 +4,15 @@ using std::string;
 using std::endl;
 using std::cout;
 #include <map>
+#include <functional>
+#include <random>
+#include <limits>
+
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Verifier.h>
+
+#include "../../src/visitor.hpp"
 
 #include <TestSuite.h>
 using CppUnit::TestSuite;
@@ -64,10 +73,6 @@ TestSuite* IntegerParser_Test::suite() {
     return testSuite;
 }
 
-OperandParser_Test::OperandParser_Test() : TestCase()
-    , block(llvm::BasicBlock::Create(context, "test_block"))
-    , parser(OperandParser(block)) {}
-
 void OperandParser_Test::testParse() {
     string str = "45";
     Lexems lexems = Lexer().tokenize(str);
@@ -77,7 +82,7 @@ void OperandParser_Test::testParse() {
     str = "name";
     lexems = Lexer().tokenize(str);
     result = parser.parse(lexems.begin(), lexems.end());
-    ASSERT(*(dynamic_cast<NameAST*>(result.ast)) == NameAST("name", block));
+    ASSERT(*(dynamic_cast<NameAST*>(result.ast)) == NameAST("name"));
 }
 
 TestSuite* OperandParser_Test::suite() {
@@ -88,10 +93,6 @@ TestSuite* OperandParser_Test::suite() {
     return _suite;
 }
 
-BinaryParser_Test::BinaryParser_Test() : TestCase()
-    , block(llvm::BasicBlock::Create(context, "test_block"))
-    , parser(BinaryParser(block)) {}
-
 BinaryParser_Test::~BinaryParser_Test() {
     for (const pair<string, BaseAST*>& test: data)
         delete test.second;
@@ -121,10 +122,6 @@ TestSuite* BinaryParser_Test::suite() {
 }
 
 
-CallInstrParser_Test::CallInstrParser_Test() : TestCase()
-    , block(llvm::BasicBlock::Create(context, "TestBlock"))
-    , parser(CallInstrParser(block)) {}
-
 CallInstrParser_Test::~CallInstrParser_Test() {
     for (const Pair& data: test_data) {
         delete data.second;
@@ -158,9 +155,6 @@ TestSuite* CallInstrParser_Test::suite() {
 
 
 
-AssignInstrParser_Test::AssignInstrParser_Test() : TestCase()
-    , block(llvm::BasicBlock::Create(context, "testBlock"))
-    , parser(AssignInstrParser(block)) {}
 AssignInstrParser_Test::~AssignInstrParser_Test() {}
 
 
@@ -190,3 +184,1083 @@ TestSuite* AssignInstrParser_Test::suite() {
     ));
     return suite;
 }
+
+
+void BlockParser_Test::testParse() {
+    const Lexems lexems = lexer.tokenize(program);
+    const ParseResult define =
+        FunctionParser().parse(lexems.begin(), lexems.end());
+    ASSERT(define.ast->getKind() == NodeKind::FUNCTION);
+    ASSERT(define.ast->str() == "[FunctionAST: [PrototypeAST: 'count' (n)] "
+        "([AssignInstrAST: total = [IntegerAST: 0]], "
+        "[WhileAST: [Name: n of [IntegerType]] do ("
+        "[AssignInstrAST: total = [BinaryInstrAST: + [Name: total of "
+        "[IntegerType]] [Name: n of [IntegerType]]]], "
+        "[AssignInstrAST: n = [BinaryInstrAST: - [Name: n of [IntegerType]] "
+        "[IntegerAST: 1]]])], "
+        "[IfAST: [BinaryInstrAST: == [Name: total of [IntegerType]] "
+        "[IntegerAST: 0]] then ([ReturnAST: [IntegerAST: 1]]) "
+        "else ([ReturnAST: [Name: total of [IntegerType]]])])]");
+    ASSERT(define.cursor->getContent() == "value");
+    delete define.ast;
+
+    const StatementParser statements;
+    size_t count = 0;
+    for (CLIter cursor = lexems.begin(); cursor != lexems.end(); ++count) {
+        const ParseResult result = statements.parse(cursor, lexems.end());
+        delete result.ast;
+        cursor = result.cursor;
+    }
+    ASSERT(count == 2);
+
+    /* each rule on its own, the last body closed by the end of the source */
+    const string branch = "if a:\n    b()";
+    const Lexems ifLexems = lexer.tokenize(branch);
+    const ParseResult ifResult =
+        IfParser().parse(ifLexems.begin(), ifLexems.end());
+    ASSERT(ifResult.cursor == ifLexems.end());
+    ASSERT(ifResult.ast->str() == "[IfAST: [Name: a of [IntegerType]] then "
+        "([CallInstrAST: 'b' ()]) else ()]");
+    delete ifResult.ast;
+
+    const string loop = "while a == 1:\n    a = 2\n";
+    const Lexems whileLexems = lexer.tokenize(loop);
+    const ParseResult whileResult =
+        WhileParser().parse(whileLexems.begin(), whileLexems.end());
+    ASSERT(whileResult.ast->getKind() == NodeKind::WHILE);
+    delete whileResult.ast;
+
+    const string ret = "return f(1) * 2\n";
+    const Lexems returnLexems = lexer.tokenize(ret);
+    const ParseResult returnResult =
+        ReturnParser().parse(returnLexems.begin(), returnLexems.end());
+    ASSERT(returnResult.ast->str() == "[ReturnAST: [BinaryInstrAST: * "
+        "[CallInstrAST: 'f' ([IntegerAST: 1])] [IntegerAST: 2]]]");
+    delete returnResult.ast;
+}
+
+void BlockParser_Test::testErrors() {
+    struct Case {
+        string source;
+        ParseErrorCode error;
+        /* of the failing lexem, and a tag it wanted */
+        size_t offset;
+        Tag wanted;
+    };
+    const vector<Case> data = {
+        {"if a:\nb = 1\n", ParseErrorCode::UNEXPECTED_LEXEM, 6, Tag::INDENT},
+        {"while a:\n", ParseErrorCode::UNEXPECTED_END, 9, Tag::INDENT},
+        {"define f(a):\n        return a\n",
+            ParseErrorCode::UNEXPECTED_LEXEM, 17, Tag::KEYWORD},
+        {"define f(a, 1):\n    return a\n",
+            ParseErrorCode::UNEXPECTED_LEXEM, 12, Tag::NAME},
+        {"return a b\n", ParseErrorCode::TRAILING_LEXEMS, 9, Tag::EOL},
+    };
+
+    StatementParser parser;
+    parser.setThrowing(false);
+    for (const Case& test: data) {
+        const Lexems lexems = lexer.tokenize(test.source);
+        const ParseResult result = parser.parse(lexems.begin(), lexems.end());
+        ASSERT(result.isError() && result.isEmpty());
+        ASSERT(result.error == test.error);
+        if (result.failure == lexems.end())
+            ASSERT(test.offset == test.source.size());
+        else
+            ASSERT(result.failure->getStart() == test.offset);
+        ASSERT(contains(result.expected, test.wanted));
+    }
+}
+
+void BlockParser_Test::testUnit() {
+    string source;
+    for (int i = 0; i < 50; ++i)
+        source += program;
+    CompilationUnit serial(source, lexer);
+    serial.parse();
+    ASSERT(serial.getStatements().size() == 100);
+
+    /* bounds never fall into a body */
+    llvm::ThreadPool pool(llvm::hardware_concurrency(4));
+    for (const size_t chunk: {1, 7, 64}) {
+        CompilationUnit unit(source, lexer);
+        unit.parse(pool, chunk);
+        ASSERT(unit.getStatements().size() == 100);
+        for (size_t i = 0; i < 100; ++i)
+            ASSERT(*unit.getStatements()[i] == *serial.getStatements()[i]);
+    }
+
+    /* a body longer than a chunk is skipped to the line after it */
+    string body = "define long(n):\n";
+    for (int i = 0; i < 1000; ++i)
+        body += "    n = n + 1\n\n";
+    body += "    return n\nx = long(1)\n";
+    CompilationUnit unit(body, lexer);
+    ASSERT(unit.getTokens().size() == unit.getLexems().size());
+    unit.parse(pool, 1);
+    ASSERT(unit.getStatements().size() == 2);
+    ASSERT(unit.getStatements()[1]->getKind() == NodeKind::ASSIGN);
+
+    /* an else continues the if before it, no chunk starts there */
+    string branches;
+    for (int i = 0; i < 200; ++i) {
+        const string n = std::to_string(i);
+        branches += "if x == " + n + ":\n    y = " + n + "\nelse:\n"
+            "    y = 0\n\n";
+        if (i % 10 == 0)
+            branches += "define f" + n + "(a):\n    if a:\n        return 1\n"
+                "    else:\n        return 2\n";
+    }
+    CompilationUnit expected(branches, lexer);
+    expected.parse();
+    ASSERT(expected.getStatements().size() == 220);
+    for (const size_t chunk: {1, 3, 7, 64}) {
+        CompilationUnit parallel(branches, lexer);
+        parallel.parse(pool, chunk);
+        ASSERT(parallel.getStatements().size() == 220);
+        for (size_t i = 0; i < 220; ++i)
+            ASSERT(*parallel.getStatements()[i] ==
+                *expected.getStatements()[i]);
+    }
+}
+
+void BlockParser_Test::testCodegen() {
+    llvm::Module& module = session.getModule();
+    llvm::Function* main = session.function("main")->getParent();
+
+    CompilationUnit unit(program + "if value == 55:\n    value = 0\n"
+        "return value / 5\n", lexer);
+    unit.parse();
+    unit.codegen(session);
+    string errors;
+    ASSERT(verify(module, &errors) && errors.empty());
+
+    llvm::Function* count = module.getFunction("count");
+    ASSERT(count != nullptr && !count->isDeclaration());
+    ASSERT(count->arg_size() == 1);
+    size_t branches = 0, returns = 0;
+    for (const llvm::BasicBlock& b: *count) {
+        const llvm::Instruction* last = b.getTerminator();
+        ASSERT(last != nullptr);
+        branches += llvm::isa<llvm::BranchInst>(last) &&
+            llvm::cast<llvm::BranchInst>(last)->isConditional();
+        returns += llvm::isa<llvm::ReturnInst>(last);
+    }
+    ASSERT(branches == 2 && returns == 2);
+    ASSERT(llvm::isa<llvm::ReturnInst>(main->back().getTerminator()));
+
+    /* unknown names and a block left without a return */
+    const auto fails = [&](const string& source, const size_t statement) {
+        Session other("failing");
+        CompilationUnit failing(source, lexer);
+        failing.parse();
+        other.function("main");
+        try {
+            failing.codegen(other);
+        } catch (const CodegenError& error) {
+            return error.getStatement() == statement;
+        }
+        return false;
+    };
+    ASSERT(fails("x = 1\nreturn y\n", 1));
+    ASSERT(fails("define f(a):\n    return b\nreturn 0\n", 0));
+    /* values of the IR are no names, the blocks fail with their function */
+    ASSERT(fails("define f(n):\n    return entry\nreturn 0\n", 0));
+    ASSERT(fails("define f(n):\n    if n:\n        return cond\n"
+        "    return 0\nreturn 0\n", 0));
+    ASSERT(fails("define f(n):\n    while n:\n        n = b\n"
+        "    return 0\nreturn 0\n", 0));
+    ASSERT(fails("x = 1\n", 1));
+    ASSERT(!fails("x = 1\nreturn x\n", 0));
+}
+
+TestSuite* BlockParser_Test::suite() {
+    auto* suite = new TestSuite;
+    suite->addTest(new TestCaller<BlockParser_Test>(
+        "testParse", &BlockParser_Test::testParse
+    ));
+    suite->addTest(new TestCaller<BlockParser_Test>(
+        "testErrors", &BlockParser_Test::testErrors
+    ));
+    suite->addTest(new TestCaller<BlockParser_Test>(
+        "testUnit", &BlockParser_Test::testUnit
+    ));
+    suite->addTest(new TestCaller<BlockParser_Test>(
+        "testCodegen", &BlockParser_Test::testCodegen
+    ));
+    return suite;
+}
+
+
+void Grammar_Test::testCombinators() {
+    using namespace Grammar;
+    using Name = Tagged<Tag::NAME>;
+    using Comma = Tagged<Tag::COMMA>;
+
+    const string str = "a, b, c d";
+    const Lexems lexems = lexer.tokenize(str);
+    const CLIter begin = lexems.begin(), end = lexems.end();
+    ParseState state;
+
+    const auto names = Rep<Name, Comma>().parse(begin, end, state);
+    ASSERT(names.success && names.value.size() == 3);
+    ASSERT(names.cursor == begin + 5);
+    ASSERT(names.value[2]->getContent() == "c");
+
+    const auto pair = Seq<Name, Comma, Name>().parse(begin, end, state);
+    ASSERT(pair.success && pair.cursor == begin + 3);
+    ASSERT(std::get<2>(pair.value)->getContent() == "b");
+
+    const auto integer = Tagged<Tag::INTEGER>().parse(begin, end, state);
+    ASSERT(!integer.success && integer.cursor == begin);
+    const auto optional = Opt<Tagged<Tag::INTEGER>>().parse(begin, end, state);
+    ASSERT(optional.success && optional.cursor == begin);
+    ASSERT(optional.value == nullptr);
+
+    const auto either =
+        Alt<Tagged<Tag::INTEGER>, Name>().parse(begin, end, state);
+    ASSERT(either.success && either.value == &*begin);
+
+    /* a failed sequence consumes nothing */
+    const auto broken = Seq<Name, Name>().parse(begin, end, state);
+    ASSERT(!broken.success && broken.cursor == begin);
+    const auto empty = Rep<Name, Comma>().parse(end, end, state);
+    ASSERT(empty.success && empty.value.empty());
+}
+
+void Grammar_Test::testCallValues() {
+    const vector<Pair> data = {
+        {"x = f(1) + 2\n", new AssignInstrAST("x",
+            new BinaryInstrAST("+",
+                new CallInstrAST("f", Args{new IntegerAST(1)}),
+                new IntegerAST(2)))},
+        {"f(g(x) * 3, y)\n", new CallInstrAST("f", Args{
+            new BinaryInstrAST("*",
+                new CallInstrAST("g", Args{new NameAST("x")}),
+                new IntegerAST(3)),
+            new NameAST("y")})},
+    };
+    const StatementParser parser;
+    for (const Pair& test: data) {
+        const Lexems lexems = lexer.tokenize(test.first);
+        const ParseResult actual = parser.parse(lexems.begin(), lexems.end());
+        ASSERT(actual.cursor == lexems.end());
+        ASSERT(*actual.ast == *test.second);
+        delete actual.ast;
+        delete test.second;
+    }
+}
+
+void Grammar_Test::testPredict() {
+    using namespace Grammar;
+    using Name = Tagged<Tag::NAME>;
+    using Open = Tagged<Tag::LEFT_BRACKET>;
+    using Call = Seq<Name, Open, Name, Tagged<Tag::RIGHT_BRACKET>>;
+    using Assign = Seq<Name, Tagged<Tag::ASSIGN>, Name, Opt<Name>>;
+
+    static_assert(Call::first() == tagSet(Tag::NAME), "FIRST of a call");
+    static_assert(Call::second() == tagSet(Tag::LEFT_BRACKET),
+        "second lexem of a call");
+    static_assert(!Call::nullable() && !Call::single(), "a call is long");
+    static_assert(Opt<Name>::nullable() && Opt<Name>::second() == ANY_TAG,
+        "an optional rule predicts nothing");
+    static_assert(Seq<Opt<Open>, Name>::first() ==
+        (tagSet(Tag::NAME) | tagSet(Tag::LEFT_BRACKET)),
+        "FIRST looks past nullable rules");
+
+    const string str = "f(a)";
+    const Lexems lexems = lexer.tokenize(str);
+    Counters counters;
+    ParseState state;
+    state.counters = &counters;
+    const auto either = Alt<Assign, Call>().parse(
+        lexems.begin(), lexems.end(), state);
+    ASSERT(either.success && either.cursor == lexems.end());
+    ASSERT(counters.attempts == 1 && counters.failures == 0);
+
+    state.predictive = false;
+    Alt<Assign, Call>().parse(lexems.begin(), lexems.end(), state);
+    ASSERT(counters.attempts == 3 && counters.failures == 1);
+
+    /* same trees either way, an LL(2) grammar needs no failed attempt */
+    const string program =
+        "x = f(1, g(h(2) * (3 + y)), k(k(k())))\n"
+        "f(x == (1 - 2) / 3)\n"
+        "y = z\n";
+    const Lexems statements = lexer.tokenize(program);
+    StatementParser parser;
+    Counters before, after;
+    for (CLIter cursor = statements.begin(); cursor != statements.end(); ) {
+        parser.setPredictive(false);
+        parser.setCounters(&before);
+        const ParseResult expected = parser.parse(cursor, statements.end());
+        parser.setPredictive(true);
+        parser.setCounters(&after);
+        const ParseResult result = parser.parse(cursor, statements.end());
+        ASSERT(result.cursor == expected.cursor);
+        ASSERT(*result.ast == *expected.ast);
+        delete expected.ast;
+        delete result.ast;
+        cursor = result.cursor;
+    }
+    ASSERT(before.failures > 0);
+    ASSERT(after.failures == 0);
+    ASSERT(after.attempts == before.attempts - before.failures);
+}
+
+void Grammar_Test::testErrors() {
+    struct Case {
+        string source;
+        ParseErrorCode error;
+        /* of the failing lexem, and a tag it wanted */
+        size_t offset;
+        Tag wanted;
+    };
+    const vector<Case> data = {
+        {"x = (1 + 2\n", ParseErrorCode::UNEXPECTED_LEXEM, 10,
+            Tag::RIGHT_BRACKET},
+        {"x = 1 +", ParseErrorCode::UNEXPECTED_END, 7, Tag::INTEGER},
+        {"f(a,, b)\n", ParseErrorCode::UNEXPECTED_LEXEM, 4, Tag::NAME},
+        {"y = = 2\n", ParseErrorCode::UNEXPECTED_LEXEM, 4, Tag::INTEGER},
+        {"x = 1 2\n", ParseErrorCode::TRAILING_LEXEMS, 6, Tag::EOL},
+        {"f(1) g\n", ParseErrorCode::TRAILING_LEXEMS, 5, Tag::EOL},
+    };
+
+    StatementParser parser;
+    for (const Case& test: data) {
+        const Lexems lexems = lexer.tokenize(test.source);
+        parser.setThrowing(false);
+        const size_t before = BaseAST::getHeapNodes();
+        const ParseResult result = parser.parse(lexems.begin(), lexems.end());
+        ASSERT(result.isError() && result.isEmpty());
+        /* what a rejected statement parsed is deleted with it */
+        ASSERT(BaseAST::getHeapNodes() == before);
+        ASSERT(result.cursor == lexems.begin());
+        ASSERT(result.error == test.error);
+        if (result.failure == lexems.end())
+            ASSERT(test.offset == test.source.size());
+        else
+            ASSERT(result.failure->getStart() == test.offset);
+        ASSERT(contains(result.expected, test.wanted));
+
+        parser.setThrowing(true);
+        bool thrown = false;
+        try {
+            parser.parse(lexems.begin(), lexems.end());
+        } catch (const ParseError& error) {
+            thrown = true;
+            ASSERT(error.getCode() == test.error);
+            ASSERT(error.getOffset() == test.offset);
+        }
+        ASSERT(thrown);
+    }
+
+    /* no error for what parses, or for an empty line */
+    const string str = "\nx = 1\n";
+    const Lexems lexems = lexer.tokenize(str);
+    parser.setThrowing(false);
+    const ParseResult empty = parser.parse(lexems.begin(), lexems.end());
+    ASSERT(!empty.isError() && empty.isEmpty());
+    const ParseResult parsed = parser.parse(empty.cursor, lexems.end());
+    ASSERT(!parsed.isError() && parsed.cursor == lexems.end());
+    delete parsed.ast;
+}
+
+void Grammar_Test::testDeep() {
+    const auto nest = [](const size_t depth) {
+        string text = "x = ";
+        for (size_t i = 0; i < depth; ++i) text += i % 2 ? "(1 + " : "f(2, ";
+        text += "3";
+        return text + string(depth, ')') + "\n";
+    };
+
+    /* far deeper than the native stack would take, the tree included */
+    StatementParser parser;
+    const string deep = nest(1000000);
+    const Lexems lexems = lexer.tokenize(deep);
+    const ParseResult result = parser.parse(lexems.begin(), lexems.end());
+    ASSERT(result.cursor == lexems.end());
+    delete result.ast;
+
+    const string shallow = nest(4);
+    const Lexems few = lexer.tokenize(shallow);
+    const ParseResult tree = parser.parse(few.begin(), few.end());
+    ASSERT(tree.ast->str() == "[AssignInstrAST: x = [CallInstrAST: 'f' "
+        "([IntegerAST: 2], [BinaryInstrAST: + [IntegerAST: 1] "
+        "[CallInstrAST: 'f' ([IntegerAST: 2], [BinaryInstrAST: + "
+        "[IntegerAST: 1] [IntegerAST: 3]])]])]]");
+    delete tree.ast;
+
+    /* a limit turns nesting into an error at the lexem past it */
+    parser.setDepthLimit(100);
+    const string limit = nest(100), past = nest(101);
+    const Lexems inside = lexer.tokenize(limit);
+    delete parser.parse(inside.begin(), inside.end()).ast;
+    const Lexems outside = lexer.tokenize(past);
+    parser.setThrowing(false);
+    const size_t before = BaseAST::getHeapNodes();
+    const ParseResult error = parser.parse(outside.begin(), outside.end());
+    ASSERT(error.error == ParseErrorCode::TOO_DEEP);
+    /* the levels parsed up to the limit are deleted again */
+    ASSERT(BaseAST::getHeapNodes() == before);
+    /* five characters a level */
+    ASSERT(error.failure->getStart() == 4 + 100 * 5);
+}
+
+void Grammar_Test::testRelease() {
+    /* parsed and dropped: call arguments, operands waiting for operators */
+    const vector<string> data = {
+        "f(1, g(2), x + 3\n",
+        "x = a * b + c -\n",
+        "x = (1 + 2) * (3 - y\n",
+        "res = 2 + add(45, variable\n",
+        "x = f(1, g(2\n",
+    };
+    StatementParser parser;
+    parser.setThrowing(false);
+    const size_t before = BaseAST::getHeapNodes();
+    for (const string& source: data) {
+        const Lexems lexems = lexer.tokenize(source);
+        for (const bool predictive: {true, false}) {
+            parser.setPredictive(predictive);
+            const ParseResult result =
+                parser.parse(lexems.begin(), lexems.end());
+            ASSERT(result.isError() && result.isEmpty());
+            ASSERT(BaseAST::getHeapNodes() == before);
+        }
+    }
+}
+
+TestSuite* Grammar_Test::suite() {
+    auto* suite = new TestSuite;
+    suite->addTest(new TestCaller<Grammar_Test>(
+        "testCombinators", &Grammar_Test::testCombinators
+    ));
+    suite->addTest(new TestCaller<Grammar_Test>(
+        "testCallValues", &Grammar_Test::testCallValues
+    ));
+    suite->addTest(new TestCaller<Grammar_Test>(
+        "testPredict", &Grammar_Test::testPredict
+    ));
+    suite->addTest(new TestCaller<Grammar_Test>(
+        "testErrors", &Grammar_Test::testErrors
+    ));
+    suite->addTest(new TestCaller<Grammar_Test>(
+        "testDeep", &Grammar_Test::testDeep
+    ));
+    suite->addTest(new TestCaller<Grammar_Test>(
+        "testRelease", &Grammar_Test::testRelease
+    ));
+    return suite;
+}
+
+
+void Arena_Test::testUnit() {
+    CompilationUnit unit(program, lexer);
+    unit.parse();
+    ASSERT(unit.getStatements().size() == 5);
+
+    const Lexems lexems = lexer.tokenize(program);
+    const StatementParser heap;
+    size_t index = 0;
+    for (CLIter cursor = lexems.begin(); cursor != lexems.end(); ) {
+        const ParseResult expected = heap.parse(cursor, lexems.end());
+        cursor = expected.cursor;
+        if (expected.isEmpty()) continue;
+        ASSERT(*unit.getStatements()[index++] == *expected.ast);
+        delete expected.ast;
+    }
+    ASSERT(index == 5);
+
+    /* 2 + 6 + 6 + 2 + 3 nodes, a header word in front of each */
+    const Arena& arena = unit.getArena();
+    ASSERT(arena.getNodes() == 19);
+    ASSERT(arena.getBytes() > arena.getNodes() * sizeof(IntegerAST));
+    ASSERT(arena.getCapacity() >= arena.getBytes());
+}
+
+void Arena_Test::testDelete() {
+    Arena arena;
+    const StatementParser parser(&arena);
+    const Lexems lexems = lexer.tokenize(program);
+    size_t count = 0;
+    for (CLIter cursor = lexems.begin(); cursor != lexems.end(); ++count) {
+        const ParseResult result = parser.parse(cursor, lexems.end());
+        /* a no-op for arena nodes, the arena frees them */
+        delete result.ast;
+        cursor = result.cursor;
+    }
+    ASSERT(count == 6);
+    ASSERT(arena.getNodes() == 19);
+
+    /* heap and arena nodes mix in one tree */
+    const CLIter print = lexems.end() - 6;
+    ASSERT(print->getContent() == "print");
+    const ParseResult call =
+        CallInstrParser(&arena).parse(print, lexems.end());
+    ASSERT(call.ast->str() == "[CallInstrAST: 'print' ([Name: res of "
+        "[IntegerType]], [Name: call of [IntegerType]])]");
+    delete new AssignInstrAST("x", call.ast);
+}
+
+void Arena_Test::testParallel() {
+    string source;
+    for (int i = 0; i < 100; ++i)
+        source += program + "\n";
+    CompilationUnit serial(source, lexer);
+    serial.parse();
+    ASSERT(serial.getStatements().size() == 500);
+
+    llvm::ThreadPool pool(llvm::hardware_concurrency(4));
+    for (const size_t chunk: {1, 7, 64, 4096}) {
+        CompilationUnit unit(source, lexer);
+        unit.parse(pool, chunk);
+        ASSERT(unit.getStatements().size() == 500);
+        for (size_t i = 0; i < 500; ++i)
+            ASSERT(*unit.getStatements()[i] == *serial.getStatements()[i]);
+        ASSERT(unit.getNodes() == serial.getNodes());
+        /* a parse frees the tree of the last one */
+        unit.parse(pool, chunk);
+        ASSERT(unit.getNodes() == serial.getNodes());
+    }
+    const size_t nodes = serial.getNodes();
+    serial.parse();
+    ASSERT(serial.getStatements().size() == 500);
+    ASSERT(serial.getNodes() == nodes);
+
+    /* the first of two errors, as the serial parse */
+    CompilationUnit invalid(
+        source + "x = = 1\n    y = 2\n" + source + "z(\n", lexer);
+    const auto failure = [&](const bool parallel) -> size_t {
+        try {
+            if (parallel) invalid.parse(pool, 16);
+            else invalid.parse();
+        } catch (const ParseError& error) {
+            ASSERT(error.getCode() == ParseErrorCode::UNEXPECTED_LEXEM);
+            return error.getOffset();
+        }
+        return 0;
+    };
+    /* the statements before it are kept either way */
+    ASSERT(failure(false) == source.size() + 4);
+    ASSERT(invalid.getStatements().size() == 500);
+    ASSERT(failure(true) == source.size() + 4);
+    ASSERT(invalid.getStatements().size() == 500);
+    ASSERT(*invalid.getStatements()[499] == *serial.getStatements()[499]);
+}
+
+TestSuite* Arena_Test::suite() {
+    auto* suite = new TestSuite;
+    suite->addTest(new TestCaller<Arena_Test>(
+        "testUnit", &Arena_Test::testUnit
+    ));
+    suite->addTest(new TestCaller<Arena_Test>(
+        "testDelete", &Arena_Test::testDelete
+    ));
+    suite->addTest(new TestCaller<Arena_Test>(
+        "testParallel", &Arena_Test::testParallel
+    ));
+    return suite;
+}
+
+
+bool IncrementalUnit_Test::same(
+    const IncrementalUnit& left, const IncrementalUnit& right
+) const {
+    if (left.getSource() != right.getSource()) return false;
+    if (left.size() != right.size()) return false;
+    if (left.isValid() != right.isValid()) return false;
+    for (size_t i = 0; i < left.size(); ++i) {
+        const IncrementalUnit::Line& l = left.getLine(i);
+        const IncrementalUnit::Line& r = right.getLine(i);
+        if (l.valid != r.valid || l.span != r.span ||
+            l.lexems.size() != r.lexems.size())
+                return false;
+        if ((l.statement == nullptr) != (r.statement == nullptr))
+            return false;
+        if (l.statement && *l.statement != *r.statement) return false;
+    }
+    return true;
+}
+
+void IncrementalUnit_Test::testEdit() {
+    IncrementalUnit unit(lexer, program);
+    ASSERT(unit.size() == 5);
+    ASSERT(unit.isValid());
+    ASSERT(unit.getSource() == program);
+    ASSERT(unit.getLine(3).statement == nullptr);
+    ASSERT(*unit.getLine(2).statement == AssignInstrAST("res",
+        new BinaryInstrAST("+", new IntegerAST(2),
+            new CallInstrAST("add", Args{
+                new IntegerAST(45), new NameAST("variable")})
+    )));
+
+    /* a keystroke touches its own line only */
+    const BaseAST* untouched = unit.getLine(2).statement.get();
+    IncrementalUnit::Change change = unit.edit(11, 1, "7");
+    ASSERT(change.line == 0 && change.removed == 1 && change.inserted == 1);
+    ASSERT(*unit.getLine(0).statement ==
+        AssignInstrAST("variable", new IntegerAST(76)));
+    ASSERT(unit.getLine(2).statement.get() == untouched);
+
+    /* joining and splitting lines */
+    const size_t join = unit.getLine(0).text.size() - 1;
+    change = unit.edit(join, 1, "");
+    ASSERT(change.removed == 2 && change.inserted == 1);
+    ASSERT(!unit.isValid());
+    change = unit.edit(join, 0, "\n");
+    ASSERT(change.removed == 1 && change.inserted == 2);
+    ASSERT(unit.isValid());
+
+    /* appending to a last line without newline */
+    const string source = unit.getSource();
+    unit.edit(source.size() - 1, 0, ", 1");
+    ASSERT(unit.size() == 5);
+    ASSERT(unit.getLine(4).text == "print(res, call, 1)");
+
+    IncrementalUnit fresh(lexer, unit.getSource());
+    ASSERT(same(unit, fresh));
+}
+
+void IncrementalUnit_Test::testBroken() {
+    IncrementalUnit unit(lexer, program);
+    for (const char* text: {"x =", "f(", "f(a,", "(a + ", "x = 1 +", "$"}) {
+        const IncrementalUnit::Change change = unit.edit(0, 0, text);
+        ASSERT(change.line == 0 && change.inserted == 1);
+        ASSERT(!unit.isValid());
+        unit.edit(0, strlen(text), "");
+        ASSERT(unit.isValid());
+        ASSERT(unit.getSource() == program);
+    }
+
+    bool thrown = false;
+    try {
+        unit.edit(program.size() + 1, 0, "x");
+    } catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    ASSERT(thrown);
+}
+
+void IncrementalUnit_Test::testBlocks() {
+    IncrementalUnit unit(lexer, "define f(a):\n    return a\nx = f(1)\n");
+    ASSERT(unit.isValid());
+    ASSERT(unit.getLine(0).span == 2 && unit.getLine(1).span == 0);
+    ASSERT(unit.getLine(1).statement == nullptr);
+    ASSERT(*unit.getLine(2).statement == AssignInstrAST("x",
+        new CallInstrAST("f", Args{new IntegerAST(1)})));
+
+    /* the statements a parse of the whole text finds, else and blanks kept */
+    IncrementalUnit whole(lexer, blocks);
+    ASSERT(whole.isValid());
+    ASSERT(whole.getLine(0).span == 10 && whole.getLine(10).span == 1);
+    ASSERT(whole.getLine(11).span == 5 && whole.getLine(16).span == 1);
+    const Lexems lexems = lexer.tokenize(blocks);
+    const StatementParser parser;
+    size_t line = 0;
+    for (CLIter cursor = lexems.begin(); cursor != lexems.end(); ) {
+        const ParseResult result = parser.parse(cursor, lexems.end());
+        cursor = result.cursor;
+        if (result.isEmpty()) continue;
+        ASSERT(line < whole.size() && whole.getLine(line).statement);
+        ASSERT(*whole.getLine(line).statement == *result.ast);
+        delete result.ast;
+        line += whole.getLine(line).span;
+    }
+    ASSERT(line == whole.size());
+
+    /* a broken body breaks every line of its statement only */
+    IncrementalUnit broken(lexer, "define f(a):\n    return a +\nx = 1\n");
+    ASSERT(!broken.isValid());
+    ASSERT(!broken.getLine(0).valid && !broken.getLine(1).valid);
+    ASSERT(broken.getLine(0).statement == nullptr);
+    ASSERT(broken.getLine(2).valid && broken.getLine(2).statement);
+}
+
+void IncrementalUnit_Test::testBody() {
+    IncrementalUnit unit(lexer, blocks);
+    const BaseAST* value = unit.getLine(10).statement.get();
+    const BaseAST* branch = unit.getLine(11).statement.get();
+
+    /* a keystroke in a body re-parses the statement around it only */
+    const size_t offset = blocks.find("total + n") + 8;
+    IncrementalUnit::Change change = unit.edit(offset, 1, "2");
+    ASSERT(change.line == 0 && change.removed == 10 && change.inserted == 10);
+    ASSERT(unit.isValid());
+    ASSERT(unit.getLine(10).statement.get() == value);
+    ASSERT(unit.getLine(11).statement.get() == branch);
+
+    unit.edit(offset, 1, "");
+    ASSERT(!unit.isValid());
+    ASSERT(!unit.getLine(0).valid && !unit.getLine(9).valid);
+    ASSERT(unit.getLine(10).valid && unit.getLine(10).statement.get() == value);
+    unit.edit(offset, 0, "n");
+    ASSERT(unit.isValid());
+
+    /* a line taken out of a body opens a statement up to the next one */
+    const size_t body = blocks.find("    print(value)");
+    change = unit.edit(body, 4, "");
+    ASSERT(change.line == 11 && change.removed == 5 && change.inserted == 5);
+    ASSERT(!unit.isValid());
+    ASSERT(unit.getLine(11).span == 1 && unit.getLine(12).span == 4);
+    change = unit.edit(body, 0, "    ");
+    ASSERT(change.line == 11 && change.removed == 5 && change.inserted == 5);
+    ASSERT(unit.isValid() && unit.getLine(11).span == 5);
+
+    /* a body typed after the last statement joins it */
+    unit.edit(unit.getSource().size(), 0, "\nwhile value:\n");
+    ASSERT(!unit.isValid());
+    change = unit.edit(unit.getSource().size(), 0, "    value = value - 1\n");
+    ASSERT(change.line == 17 && change.removed == 1 && change.inserted == 2);
+    ASSERT(unit.isValid() && unit.getLine(17).span == 2);
+
+    IncrementalUnit fresh(lexer, unit.getSource());
+    ASSERT(same(unit, fresh));
+}
+
+void IncrementalUnit_Test::testRandom() {
+    std::mt19937 random(42);
+    const vector<string> pieces = {
+        "\n", "a", " = ", "f(", ")", ", ", "12", " + ", "(", "x", "\n\n",
+    };
+    /* long enough to span several pages of lines */
+    string source;
+    for (int i = 0; i < 150; ++i) source += program + "\n";
+    IncrementalUnit unit(lexer, source);
+    for (int i = 0; i < 200; ++i) {
+        const size_t length = unit.getSource().size();
+        const size_t offset = random() % (length + 1);
+        const size_t removed = random() % (length - offset + 1) %
+            (i % 10 == 0 ? 4096 : 8);
+        unit.edit(offset, removed, pieces[random() % pieces.size()]);
+
+        IncrementalUnit fresh(lexer, unit.getSource());
+        ASSERT(same(unit, fresh));
+    }
+
+    /* bodies opened, closed and indented at random */
+    const vector<string> nested = {
+        "\n", "    ", "if x:\n", "else:\n", "while a:\n    ", ":", "n = 1",
+        "return n\n", "define f(a):\n    ",
+    };
+    source.clear();
+    for (int i = 0; i < 40; ++i) source += blocks + "\n";
+    IncrementalUnit block(lexer, source);
+    ASSERT(block.isValid());
+    for (int i = 0; i < 300; ++i) {
+        const size_t length = block.getSource().size();
+        const size_t offset = random() % (length + 1);
+        const size_t removed = random() % (length - offset + 1) %
+            (i % 10 == 0 ? 4096 : 8);
+        block.edit(offset, removed, nested[random() % nested.size()]);
+
+        IncrementalUnit fresh(lexer, block.getSource());
+        ASSERT(same(block, fresh));
+    }
+}
+
+TestSuite* IncrementalUnit_Test::suite() {
+    auto* suite = new TestSuite;
+    suite->addTest(new TestCaller<IncrementalUnit_Test>(
+        "testEdit", &IncrementalUnit_Test::testEdit
+    ));
+    suite->addTest(new TestCaller<IncrementalUnit_Test>(
+        "testBroken", &IncrementalUnit_Test::testBroken
+    ));
+    suite->addTest(new TestCaller<IncrementalUnit_Test>(
+        "testBlocks", &IncrementalUnit_Test::testBlocks
+    ));
+    suite->addTest(new TestCaller<IncrementalUnit_Test>(
+        "testBody", &IncrementalUnit_Test::testBody
+    ));
+    suite->addTest(new TestCaller<IncrementalUnit_Test>(
+        "testRandom", &IncrementalUnit_Test::testRandom
+    ));
+    return suite;
+}
+
+
+void FlatAST_Test::testPrint() {
+    const Lexems lexems = lexer.tokenize(program);
+    FlatAST tree;
+    const FlatStatementParser flat(tree);
+    const StatementParser heap;
+
+    CLIter cursor = lexems.begin();
+    while (cursor != lexems.end()) {
+        const ParseResult expected = heap.parse(cursor, lexems.end());
+        const FlatParseResult result = flat.parse(cursor, lexems.end());
+        ASSERT(result.cursor == expected.cursor);
+        ASSERT(result.isEmpty() == expected.isEmpty());
+        if (!expected.isEmpty())
+            ASSERT(tree.str(result.node) == expected.ast->str());
+        delete expected.ast;
+        cursor = result.cursor;
+    }
+    ASSERT(tree.getRoots().size() == 5);
+    /* 2 + 10 + 6 + 4 + 3 nodes, children before their parents */
+    ASSERT(tree.size() == 25);
+    for (const NodeId root: tree.getRoots())
+        if (tree.getKind(root) == NodeKind::BINARY)
+            ASSERT(tree.getLeft(root) < root && tree.getRight(root) < root);
+
+    /* the same errors as the tree parser */
+    const string text = "x = (1 + 2\n";
+    const Lexems broken = lexer.tokenize(text);
+    bool thrown = false;
+    try {
+        flat.parse(broken.begin(), broken.end());
+    } catch (const ParseError&) {
+        thrown = true;
+    }
+    ASSERT(thrown);
+    ASSERT(tree.getRoots().size() == 5);
+}
+
+void FlatAST_Test::testCodegen() {
+    llvm::LLVMContext& context = session.getContext();
+    llvm::Module& module = session.getModule();
+    llvm::Type* integer = llvm::Type::getInt32Ty(context);
+    llvm::Function::Create(
+        llvm::FunctionType::get(integer, {integer, integer}, false),
+        llvm::Function::ExternalLinkage, "add", module);
+    llvm::Function* main = llvm::Function::Create(
+        llvm::FunctionType::get(integer, false),
+        llvm::Function::ExternalLinkage, "main", module);
+    llvm::BasicBlock* entry = llvm::BasicBlock::Create(context, "entry", main);
+    llvm::IRBuilder<>& builder = session.getBuilder();
+    builder.SetInsertPoint(entry);
+    /* a value of the IR with the name of a local is no local */
+    builder.CreateFreeze(builder.getInt32(1), "t");
+
+    const string text =
+        "a = 2 + add(3, 4)\n"
+        "a = a * (a - 1) == 42\n"
+        "b = a / 0\n"
+        "c = missing(z)\n"
+        "d = add(undefined, 1)\n"
+        "e = add(1)\n"
+        "f = add(1, 2, 3)\n"
+        "g = t\n";
+    const Lexems lexems = lexer.tokenize(text);
+    FlatAST tree;
+    const FlatStatementParser parser(tree);
+    for (CLIter cursor = lexems.begin(); cursor != lexems.end(); )
+        cursor = parser.parse(cursor, lexems.end()).cursor;
+    ASSERT(tree.getRoots().size() == 8);
+
+    const llvm::ArrayRef<NodeId> roots = tree.getRoots();
+    ASSERT(tree.codegen(roots[0], session) != nullptr);
+    ASSERT(tree.codegen(roots[1], session) != nullptr);
+    /* x / 0 is 0, as the tree codegen makes it */
+    auto* zero = llvm::dyn_cast_or_null<llvm::StoreInst>(
+        tree.codegen(roots[2], session));
+    ASSERT(zero != nullptr);
+    auto* stored = llvm::dyn_cast<llvm::ConstantInt>(zero->getValueOperand());
+    ASSERT(stored != nullptr && stored->isZero());
+    llvm::Value* result = tree.codegen(tree.getValueNode(roots[1]), session);
+    ASSERT(result != nullptr);
+    builder.CreateRet(result);
+    ASSERT(!llvm::verifyFunction(*main, &llvm::errs()));
+
+    /* one slot a local, named after it, at the top of the entry block */
+    vector<string> slots;
+    for (const llvm::Instruction& instruction: *entry)
+        if (llvm::isa<llvm::AllocaInst>(instruction))
+            slots.push_back(instruction.getName().str());
+    ASSERT(slots == vector<string>({"b", "a"}));
+    ASSERT(llvm::isa<llvm::AllocaInst>(entry->front()));
+
+    /* unknown names and functions and calls of the wrong arity fail */
+    llvm::BasicBlock* rest = llvm::BasicBlock::Create(context, "rest", main);
+    builder.SetInsertPoint(rest);
+    for (size_t i = 3; i < roots.size(); ++i)
+        ASSERT(tree.codegen(roots[i], session) == nullptr);
+    ASSERT(tree.codegen(tree.getArguments(tree.getValueNode(roots[3]))[0],
+        session) == nullptr);
+    ASSERT(rest->empty());
+    rest->eraseFromParent();
+    ASSERT(verify(module));
+}
+
+TestSuite* FlatAST_Test::suite() {
+    auto* suite = new TestSuite;
+    suite->addTest(new TestCaller<FlatAST_Test>(
+        "testPrint", &FlatAST_Test::testPrint
+    ));
+    suite->addTest(new TestCaller<FlatAST_Test>(
+        "testCodegen", &FlatAST_Test::testCodegen
+    ));
+    return suite;
+}
+
+
+void Jit_Test::compile(
+    const string& source, JitRunner& jit, Optimizer* optimizer
+) const {
+    Session session("jit");
+    CompilationUnit unit(source, lexer);
+    unit.parse();
+    session.function("main");
+    unit.codegen(session);
+    if (optimizer != nullptr) {
+        optimizer->run(session.getModule(), &jit.getTarget());
+        ASSERT(verify(session.getModule()));
+        ASSERT(session.getModule().getDataLayout() ==
+            jit.getTarget().createDataLayout());
+    }
+    jit.add(session);
+}
+
+void Jit_Test::testRun() {
+    JitRunner jit;
+    compile(program, jit);
+    ASSERT(jit.lookup<int()>("main")() == 110);
+
+    auto* count = jit.lookup<int(int)>("count");
+    auto* fib = jit.lookup<int(int)>("fib");
+    auto* add = jit.lookup<int(int, int)>("add");
+    ASSERT(count(100) == 5050 && count(0) == 0);
+    ASSERT(fib(20) == 6765);
+    int sum = 0;
+    for (int i = 0; i < 1000; ++i)
+        sum = add(sum, i);
+    ASSERT(sum == 499500);
+}
+
+void Jit_Test::testErrors() {
+    JitRunner jit;
+    compile(program, jit);
+    const auto throws = [&](std::function<void()> body) {
+        try {
+            body();
+        } catch (const JitError& error) {
+            return !error.getMessage().empty();
+        }
+        return false;
+    };
+    ASSERT(throws([&] { jit.lookup<int()>("missing"); }));
+    ASSERT(throws([&] { jit.lookup<int(int)>("add"); }));
+    /* a second definition of a function the jit already has */
+    ASSERT(throws([&] {
+        compile("define add(a, b):\n    return a\nreturn 0\n", jit);
+    }));
+    ASSERT(jit.lookup<int(int, int)>("add")(2, 3) == 5);
+    /* nothing of a rejected module is known, arities neither */
+    ASSERT(throws([&] {
+        compile("define sub(a, b):\n    return a - b\n"
+            "define add(a):\n    return a\nreturn 0\n", jit);
+    }));
+    ASSERT(jit.lookup<int(int, int)>("add")(2, 3) == 5);
+    ASSERT(throws([&] { jit.lookup<int(int, int)>("sub"); }));
+}
+
+void Jit_Test::testDivision() {
+    const string source =
+        "define div(a, b):\n"
+        "    return a / b\n"
+        "return 7 / 0\n";
+    for (const OptLevel level: {OptLevel::O0, OptLevel::O2}) {
+        Optimizer optimizer(level);
+        JitRunner jit;
+        compile(source, jit, &optimizer);
+        ASSERT(jit.lookup<int()>("main")() == 0);
+
+        auto* div = jit.lookup<int(int, int)>("div");
+        const int min = std::numeric_limits<int>::min();
+        ASSERT(div(7, 2) == 3 && div(-7, 2) == -3 && div(7, -1) == -7);
+        ASSERT(div(7, 0) == 0 && div(min, 0) == 0);
+        ASSERT(div(min, -1) == min && div(min, 1) == min);
+    }
+}
+
+void Jit_Test::testLevels() {
+    for (const OptLevel level:
+            {OptLevel::O0, OptLevel::O1, OptLevel::O2, OptLevel::O3}) {
+        Optimizer optimizer(level);
+        JitRunner jit;
+        compile(program, jit, &optimizer);
+        ASSERT(jit.lookup<int()>("main")() == 110);
+        ASSERT(jit.lookup<int(int)>("count")(100) == 5050);
+        ASSERT(jit.lookup<int(int)>("fib")(20) == 6765);
+
+        const vector<PassTime>& times = optimizer.getTimes();
+        ASSERT(times.empty() == (level == OptLevel::O0));
+        bool promoted = false;
+        for (const PassTime& pass: times) {
+            ASSERT(pass.runs > 0 && pass.seconds >= 0);
+            promoted = promoted || pass.name == "PromotePass" ||
+                pass.name == "SROAPass";
+        }
+        ASSERT(promoted == (level != OptLevel::O0));
+    }
+
+    /* the slots of count are gone after mem2reg */
+    Session session("levels");
+    CompilationUnit unit(program, lexer);
+    unit.parse();
+    session.function("main");
+    unit.codegen(session);
+    Optimizer optimizer(OptLevel::O1);
+    optimizer.setTiming(false);
+    optimizer.run(session.getModule());
+    ASSERT(optimizer.getTimes().empty());
+    for (const llvm::BasicBlock& block:
+            *session.getModule().getFunction("count"))
+        for (const llvm::Instruction& instruction: block)
+            ASSERT(!llvm::isa<llvm::AllocaInst>(instruction));
+}
+
+void Jit_Test::testSessions() {
+    /* program i returns count(10 * i) + fib(i % 16) */
+    const size_t programs = 16;
+    vector<int> results(programs, -1);
+    vector<std::exception_ptr> errors(programs);
+    llvm::ThreadPool pool(llvm::hardware_concurrency(4));
+    for (size_t i = 0; i < programs; ++i) {
+        pool.async([&, i] {
+            try {
+                const string source = program.substr(0,
+                    program.find("return count(10)")) +
+                    "return count(" + std::to_string(10 * i) + ") + fib(" +
+                    std::to_string(i % 16) + ")\n";
+                Optimizer optimizer(i % 2 == 0 ? OptLevel::O0 : OptLevel::O2);
+                JitRunner jit;
+                compile(source, jit, &optimizer);
+                results[i] = jit.lookup<int()>("main")();
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        });
+    }
+    pool.wait();
+
+    int fib[16] = {0, 1};
+    for (size_t i = 2; i < 16; ++i)
+        fib[i] = fib[i - 1] + fib[i - 2];
+    for (size_t i = 0; i < programs; ++i) {
+        ASSERT(!errors[i]);
+        const int n = static_cast<int>(10 * i);
+        ASSERT(results[i] == n * (n + 1) / 2 + fib[i % 16]);
+    }
+}
+
+TestSuite* Jit_Test::suite() {
+    auto* suite = new TestSuite;
+    suite->addTest(new TestCaller<Jit_Test>(
+        "testRun", &Jit_Test::testRun
+    ));
+    suite->addTest(new TestCaller<Jit_Test>(
+        "testErrors", &Jit_Test::testErrors
+    ));
+    suite->addTest(new TestCaller<Jit_Test>(
+        "testDivision", &Jit_Test::testDivision
+    ));
+    suite->addTest(new TestCaller<Jit_Test>(
+        "testLevels", &Jit_Test::testLevels
+    ));
+    suite->addTest(new TestCaller<Jit_Test>(
+        "testSessions", &Jit_Test::testSessions
+    ));
+    return suite;
+}
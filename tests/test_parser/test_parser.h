@@ -5,6 +5,10 @@ using std::map;
 using std::pair;
 
 #include "../../src/parser.hpp"
+#include "../../src/incremental.hpp"
+#include "../../src/unit.hpp"
+#include "../../src/jit.hpp"
+#include "../../src/optimizer.hpp"
 #include "../../src/lexer.hpp"
 
 #include <CppUnitCommon.hpp>
@@ -20,12 +24,9 @@ public:
 };
 
 class OperandParser_Test : public TestCase {
-    llvm::BasicBlock* block = nullptr;
     OperandParser parser;
 
 public:
-    OperandParser_Test();
-    ~OperandParser_Test() { delete block; }
 
     void testParse();
 
@@ -34,7 +35,6 @@ public:
 
 
 class BinaryParser_Test : public TestCase {
-    llvm::BasicBlock* block = nullptr;
     BinaryParser parser;
     Lexer lexer;
 
@@ -69,10 +69,34 @@ class BinaryParser_Test : public TestCase {
                 new NameAST("h")
             )
         },
+        {"a - b - c", new BinaryInstrAST("-",
+                new BinaryInstrAST("-", new NameAST("a"), new NameAST("b")),
+                new NameAST("c")
+            )
+        },
+        {"a == b + c * d", new BinaryInstrAST("==",
+                new NameAST("a"),
+                new BinaryInstrAST("+", new NameAST("b"),
+                    new BinaryInstrAST("*", new NameAST("c"), new NameAST("d"))
+                )
+            )
+        },
+        {"a * b + c / d - e == 1", new BinaryInstrAST("==",
+                new BinaryInstrAST("-",
+                    new BinaryInstrAST("+",
+                        new BinaryInstrAST("*",
+                            new NameAST("a"), new NameAST("b")),
+                        new BinaryInstrAST("/",
+                            new NameAST("c"), new NameAST("d"))
+                    ),
+                    new NameAST("e")
+                ),
+                new IntegerAST(1)
+            )
+        },
     };
 
 public:
-    BinaryParser_Test();
     ~BinaryParser_Test();
 
     void test();
@@ -83,8 +107,6 @@ public:
 using Pair = std::pair<string, BaseAST*>;
 using Args = vector<BaseAST*>;
 class CallInstrParser_Test : public TestCase {
-
-    llvm::BasicBlock* block = nullptr;
     CallInstrParser parser;
     Lexer lexer;
 
@@ -116,7 +138,6 @@ class CallInstrParser_Test : public TestCase {
     };
 
 public:
-    CallInstrParser_Test();
     virtual ~CallInstrParser_Test() override;
 
     void test();
@@ -126,7 +147,6 @@ public:
 
 
 class AssignInstrParser_Test final : public TestCase {
-    llvm::BasicBlock* block = nullptr;
     AssignInstrParser parser;
     Lexer lexer;
 
@@ -145,7 +165,6 @@ class AssignInstrParser_Test final : public TestCase {
     };
 
 public:
-    AssignInstrParser_Test();
     ~AssignInstrParser_Test();
 
     void test();
@@ -154,6 +173,172 @@ public:
 };
 
 
+class BlockParser_Test final : public TestCase {
+    Session session;
+    Lexer lexer;
+
+    const string program =
+        "define count(n):\n"
+        "    total = 0\n"
+        "    while n:\n"
+        "        total = total + n\n"
+        "\n"
+        "        n = n - 1\n"
+        "    if total == 0:\n"
+        "        return 1\n"
+        "    else:\n"
+        "        return total\n"
+        "value = count(10)\n";
+
+public:
+
+    void testParse();
+    void testErrors();
+    void testUnit();
+    void testCodegen();
+
+    static TestSuite* suite();
+};
+
+
+class Grammar_Test final : public TestCase {
+    Lexer lexer;
+
+public:
+
+    void testCombinators();
+    void testCallValues();
+    void testPredict();
+    void testErrors();
+    void testDeep();
+    void testRelease();
+
+    static TestSuite* suite();
+};
+
+
+class Arena_Test final : public TestCase {
+    Lexer lexer;
+
+    const string program =
+        "variable = 56\n"
+        "res = 2 + add(45, variable)\n"
+        "\n"
+        "call(nested(45 / 3), name)\n"
+        "x = y\n"
+        "print(res, call)";
+
+public:
+
+    void testUnit();
+    void testDelete();
+    void testParallel();
+
+    static TestSuite* suite();
+};
+
+
+class IncrementalUnit_Test final : public TestCase {
+    Lexer lexer;
+
+    const string program =
+        "variable = 56\n"
+        "call = callable()\n"
+        "res = 2 + add(45, variable)\n"
+        "\n"
+        "print(res, call)";
+
+    const string blocks =
+        "define count(n):\n"
+        "    total = 0\n"
+        "    while n:\n"
+        "        total = total + n\n"
+        "\n"
+        "        n = n - 1\n"
+        "    if total == 0:\n"
+        "        return 1\n"
+        "    else:\n"
+        "        return total\n"
+        "value = count(10)\n"
+        "if value == 55:\n"
+        "    print(value)\n"
+        "else:\n"
+        "    print(0)\n"
+        "\n"
+        "print(value)";
+
+public:
+
+    void testEdit();
+    void testBroken();
+    void testBlocks();
+    void testBody();
+    void testRandom();
+
+    static TestSuite* suite();
+
+private:
+    bool same(const IncrementalUnit&, const IncrementalUnit&) const;
+};
+
+
+class FlatAST_Test final : public TestCase {
+    Session session;
+    Lexer lexer;
+
+    const string program =
+        "variable = 56\n"
+        "res = 2 + add(45, variable) * (3 - 1)\n"
+        "\n"
+        "call(nested(45 / 3), name)\n"
+        "x = y == 1\n"
+        "print(res, call())";
+
+public:
+
+    void testPrint();
+    void testCodegen();
+
+    static TestSuite* suite();
+};
+
+
+class Jit_Test final : public TestCase {
+    Lexer lexer;
+
+    const string program =
+        "define count(n):\n"
+        "    total = 0\n"
+        "    while n:\n"
+        "        total = total + n\n"
+        "        n = n - 1\n"
+        "    return total\n"
+        "define fib(n):\n"
+        "    if n == 0:\n"
+        "        return 0\n"
+        "    if n == 1:\n"
+        "        return 1\n"
+        "    return fib(n - 1) + fib(n - 2)\n"
+        "define add(a, b):\n"
+        "    return a + b\n"
+        "return count(10) + fib(10)\n";
+
+public:
+    void testRun();
+    void testErrors();
+    void testDivision();
+    void testLevels();
+    void testSessions();
+
+    static TestSuite* suite();
+
+private:
+    /* source parsed into main of a fresh module, which is added to jit */
+    void compile(const string& source, JitRunner& jit,
+        Optimizer* optimizer=nullptr) const;
+};
+
+
 void run() {
     cout << __PRETTY_FUNCTION__ << endl;
     TestRunner runner;
@@ -162,6 +347,12 @@ void run() {
     runner.addTest(BinaryParser_Test::suite());
     runner.addTest(CallInstrParser_Test::suite());
     runner.addTest(AssignInstrParser_Test::suite());
+    runner.addTest(BlockParser_Test::suite());
+    runner.addTest(Grammar_Test::suite());
+    runner.addTest(Arena_Test::suite());
+    runner.addTest(IncrementalUnit_Test::suite());
+    runner.addTest(FlatAST_Test::suite());
+    runner.addTest(Jit_Test::suite());
     runner.run();
 }
 }